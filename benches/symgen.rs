@@ -0,0 +1,335 @@
+//! Benchmarks for the main `resymgen` processing phases, run against the `symbols/` tree and
+//! synthetic scaled-up copies of it.
+//!
+//! Run with `cargo bench --bench symgen`. By default, the tree is benchmarked at scales 1, 10,
+//! and 100, where a tree at scale N has N copies of every symbol (the copies are renamed, but
+//! otherwise identical). Other scales can be selected with `cargo bench --bench symgen -- 1 5`.
+//!
+//! For each phase, the benchmark reports the time taken, the throughput (in YAML bytes per second
+//! for reading, and symbols per second otherwise), and the peak heap memory allocated during the
+//! phase (on top of what was already allocated before the phase started).
+
+use std::alloc::{GlobalAlloc, Layout, System};
+use std::env;
+use std::error::Error;
+use std::fs::{self, File};
+use std::io;
+use std::path::{Path, PathBuf};
+use std::sync::atomic::{AtomicUsize, Ordering};
+use std::time::{Duration, Instant};
+
+use resymgen::data_formats::ghidra_csv::CsvLoader;
+use resymgen::data_formats::symgen_yml::{
+    AddSymbol, Block, IntFormat, Load, LoadParams, Sort, Subregion, SymGen, SymbolType,
+};
+use resymgen::data_formats::Generate;
+use resymgen::OutFormat;
+
+/// Wraps the system allocator to keep track of current and peak heap usage.
+struct CountingAllocator;
+
+static ALLOCATED: AtomicUsize = AtomicUsize::new(0);
+static PEAK: AtomicUsize = AtomicUsize::new(0);
+
+unsafe impl GlobalAlloc for CountingAllocator {
+    unsafe fn alloc(&self, layout: Layout) -> *mut u8 {
+        let ptr = System.alloc(layout);
+        if !ptr.is_null() {
+            let allocated = ALLOCATED.fetch_add(layout.size(), Ordering::Relaxed) + layout.size();
+            PEAK.fetch_max(allocated, Ordering::Relaxed);
+        }
+        ptr
+    }
+    unsafe fn dealloc(&self, ptr: *mut u8, layout: Layout) {
+        System.dealloc(ptr, layout);
+        ALLOCATED.fetch_sub(layout.size(), Ordering::Relaxed);
+    }
+}
+
+#[global_allocator]
+static GLOBAL: CountingAllocator = CountingAllocator;
+
+/// Amount of work done by a phase, for computing throughput.
+enum Work {
+    Symbols(usize),
+    Bytes(u64),
+}
+
+/// Runs `f`, then prints its running time, throughput, and peak memory under `name`.
+fn measure<T, F>(name: &str, work: Work, f: F) -> T
+where
+    F: FnOnce() -> T,
+{
+    let baseline = ALLOCATED.load(Ordering::Relaxed);
+    PEAK.store(baseline, Ordering::Relaxed);
+    let start = Instant::now();
+    let result = f();
+    let elapsed = start.elapsed();
+    let peak = PEAK.load(Ordering::Relaxed) - baseline;
+    let secs = elapsed.max(Duration::from_nanos(1)).as_secs_f64();
+    let throughput = match work {
+        Work::Symbols(n) => format!("{:.0} symbols/s", n as f64 / secs),
+        Work::Bytes(n) => format!("{:.2} MiB/s", n as f64 / (1024.0 * 1024.0) / secs),
+    };
+    println!(
+        "  {:<24} {:>10.2} ms {:>20} {:>10.2} MiB peak",
+        name,
+        elapsed.as_secs_f64() * 1000.0,
+        throughput,
+        peak as f64 / (1024.0 * 1024.0),
+    );
+    result
+}
+
+/// Returns all the YAML files under `dir`, in sorted order.
+fn yaml_files(dir: &Path) -> io::Result<Vec<PathBuf>> {
+    let mut files = Vec::new();
+    let mut paths = fs::read_dir(dir)?
+        .map(|entry| entry.map(|e| e.path()))
+        .collect::<io::Result<Vec<_>>>()?;
+    paths.sort();
+    for path in paths {
+        if path.is_dir() {
+            files.extend(yaml_files(&path)?);
+        } else if path.extension().map_or(false, |ext| ext == "yml") {
+            files.push(path);
+        }
+    }
+    Ok(files)
+}
+
+/// Writes a copy of the tree at `src_dir` to `dst_dir`, with `scale` copies of every symbol.
+fn write_scaled_tree(src_dir: &Path, dst_dir: &Path, scale: usize) -> Result<(), Box<dyn Error>> {
+    for src in yaml_files(src_dir)? {
+        let mut symgen = SymGen::read(File::open(&src)?)?;
+        for block in symgen.blocks_mut() {
+            for list in [&mut block.functions, &mut block.data] {
+                let originals: Vec<_> = list.iter().cloned().collect();
+                for i in 1..scale {
+                    for symbol in originals.iter() {
+                        let mut copy = symbol.clone();
+                        copy.name = format!("{}__{}", symbol.name, i);
+                        copy.aliases = None;
+                        list.push(copy);
+                    }
+                }
+            }
+        }
+        let dst = dst_dir.join(src.strip_prefix(src_dir)?);
+        if let Some(parent) = dst.parent() {
+            fs::create_dir_all(parent)?;
+        }
+        symgen.write(File::create(dst)?, IntFormat::Hexadecimal)?;
+    }
+    Ok(())
+}
+
+fn count_symbols(symgen: &SymGen) -> usize {
+    symgen
+        .blocks()
+        .map(|b| b.functions.len() + b.data.len())
+        .sum()
+}
+
+/// Writes the symbols in `block` for `version` as a Ghidra CSV export, like one from a fully
+/// analyzed project, and returns the number of rows.
+fn write_ghidra_csv(csv: &mut Vec<u8>, block: &Block, version: &str) -> usize {
+    let mut n_rows = 0;
+    csv.extend_from_slice(b"\"Name\",\"Location\",\"Type\"\n");
+    for (stype, symbols) in [
+        (
+            "Function",
+            block.functions_realized(version).collect::<Vec<_>>(),
+        ),
+        ("Data Label", block.data_realized(version).collect()),
+    ] {
+        for s in symbols {
+            csv.extend_from_slice(
+                format!("\"{}\",\"{:x}\",\"{}\"\n", s.name, s.address, stype).as_bytes(),
+            );
+            n_rows += 1;
+        }
+    }
+    n_rows
+}
+
+fn all_versions(symgen: &SymGen) -> Vec<String> {
+    let mut versions: Vec<_> = symgen
+        .blocks()
+        .flat_map(|b| b.versions.iter().flatten())
+        .map(|v| v.name().to_string())
+        .collect();
+    versions.sort();
+    versions.dedup();
+    versions
+}
+
+/// Benchmarks all the phases on the top-level files (and their subregions) in `dir`.
+fn bench_tree(dir: &Path) -> Result<(), Box<dyn Error>> {
+    let top_level: Vec<_> = yaml_files(dir)?
+        .into_iter()
+        .filter(|p| p.parent() == Some(dir))
+        .collect();
+    let all_files = yaml_files(dir)?;
+    let total_size = |files: &[PathBuf]| {
+        files
+            .iter()
+            .map(|p| fs::metadata(p).map(|m| m.len()))
+            .sum::<io::Result<u64>>()
+    };
+    let n_bytes = total_size(&all_files)?;
+    let top_level_bytes = total_size(&top_level)?;
+    println!(
+        "  {} files, {:.2} MiB of YAML",
+        all_files.len(),
+        n_bytes as f64 / (1024.0 * 1024.0)
+    );
+
+    // Reading is measured over all files, including subregion files, so that it's comparable to
+    // the cost of resolving subregions.
+    let symgens = measure("read (all files)", Work::Bytes(n_bytes), || {
+        all_files
+            .iter()
+            .map(|p| SymGen::read(File::open(p)?).map_err(Into::into))
+            .collect::<Result<Vec<_>, Box<dyn Error>>>()
+    })?;
+    let n_symbols: usize = symgens.iter().map(count_symbols).sum();
+    drop(symgens);
+    println!("  {} symbols", n_symbols);
+
+    let mut trees = measure("read (top level)", Work::Bytes(top_level_bytes), || {
+        top_level
+            .iter()
+            .map(|p| SymGen::read(File::open(p)?).map_err(Into::into))
+            .collect::<Result<Vec<_>, Box<dyn Error>>>()
+    })?;
+    measure("resolve_subregions", Work::Symbols(n_symbols), || {
+        for (path, tree) in top_level.iter().zip(trees.iter_mut()) {
+            tree.resolve_subregions(Subregion::subregion_dir(path), |p| File::open(p))?;
+        }
+        Ok::<_, Box<dyn Error>>(())
+    })?;
+    measure("collapse_subregions", Work::Symbols(n_symbols), || {
+        for tree in trees.iter_mut() {
+            tree.collapse_subregions();
+        }
+    });
+    let mut sorted = trees.clone();
+    measure("sort", Work::Symbols(n_symbols), || {
+        for tree in sorted.iter_mut() {
+            tree.sort();
+        }
+    });
+    drop(sorted);
+
+    // Re-merging every symbol into a copy of its own tree exercises symbol lookup and
+    // conflict-free merging, like a bulk import that mostly touches existing symbols.
+    let to_merge: Vec<Vec<AddSymbol>> = trees
+        .iter()
+        .map(|tree| {
+            tree.iter()
+                .flat_map(|(bname, block)| {
+                    let functions = block.functions.iter().map(|s| (SymbolType::Function, s));
+                    let data = block.data.iter().map(|s| (SymbolType::Data, s));
+                    functions.chain(data).map(move |(stype, s)| AddSymbol {
+                        symbol: s.clone(),
+                        stype,
+                        block_name: Some(bname.val.clone()),
+                    })
+                })
+                .collect()
+        })
+        .collect();
+    let mut merged = trees.clone();
+    measure("merge_symbols", Work::Symbols(n_symbols), || {
+        for (tree, symbols) in merged.iter_mut().zip(to_merge) {
+            tree.merge_symbols(symbols.into_iter())?;
+        }
+        Ok::<_, Box<dyn Error>>(())
+    })?;
+    measure("merge_symgen", Work::Symbols(n_symbols), || {
+        for (tree, other) in merged.iter_mut().zip(trees.iter()) {
+            tree.merge_symgen(other)?;
+        }
+        Ok::<_, Box<dyn Error>>(())
+    })?;
+
+    // Synthetic Ghidra exports of every block and version, merged back into the trees they came
+    // from, like a merge of fresh analysis into the symbol tables.
+    let mut exports = Vec::new();
+    let mut n_rows = 0;
+    for (i, tree) in trees.iter().enumerate() {
+        for version in all_versions(tree) {
+            for (bname, block) in tree.iter() {
+                let mut csv = Vec::new();
+                n_rows += write_ghidra_csv(&mut csv, block, &version);
+                let params = LoadParams {
+                    default_block_name: Some(bname.val.clone()),
+                    default_symbol_type: None,
+                    default_version_name: Some(version.clone()),
+                };
+                exports.push((i, csv, params));
+            }
+        }
+    }
+    let csv_bytes: u64 = exports.iter().map(|(_, csv, _)| csv.len() as u64).sum();
+    let loaded = measure("load (ghidra csv)", Work::Bytes(csv_bytes), || {
+        exports
+            .iter()
+            .map(|(i, csv, params)| Ok((*i, CsvLoader::load(csv.as_slice(), params)?)))
+            .collect::<Result<Vec<_>, Box<dyn Error>>>()
+    })?;
+    drop(exports);
+    measure("merge_symbols (ghidra csv)", Work::Symbols(n_rows), || {
+        for (i, loader) in loaded {
+            merged[i].merge_symbols(loader)?;
+        }
+        Ok::<_, Box<dyn Error>>(())
+    })?;
+    drop(merged);
+
+    for format in OutFormat::all() {
+        let mut n_realized = 0;
+        for tree in trees.iter() {
+            n_realized += all_versions(tree).len() * count_symbols(tree);
+        }
+        measure(
+            &format!("generate ({})", format.extension()),
+            Work::Symbols(n_realized),
+            || {
+                for tree in trees.iter() {
+                    for version in all_versions(tree) {
+                        format.generate(io::sink(), tree, &version)?;
+                    }
+                }
+                Ok::<_, Box<dyn Error>>(())
+            },
+        )?;
+    }
+    Ok(())
+}
+
+fn main() -> Result<(), Box<dyn Error>> {
+    // Cargo passes --bench to harness = false benchmarks; ignore any flags
+    let mut scales = env::args()
+        .skip(1)
+        .filter(|arg| !arg.starts_with('-'))
+        .map(|arg| arg.parse::<usize>())
+        .collect::<Result<Vec<_>, _>>()?;
+    if scales.is_empty() {
+        scales = vec![1, 10, 100];
+    }
+
+    let symbols_dir = Path::new(env!("CARGO_MANIFEST_DIR")).join("symbols");
+    for scale in scales {
+        println!("Scale {}x:", scale);
+        if scale <= 1 {
+            bench_tree(&symbols_dir)?;
+        } else {
+            let dir = tempfile::tempdir()?;
+            write_scaled_tree(&symbols_dir, dir.path(), scale)?;
+            bench_tree(dir.path())?;
+        }
+    }
+    Ok(())
+}
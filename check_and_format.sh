@@ -9,6 +9,6 @@ make -C headers
 make -C headers format
 make -C headers symbol-check
 
-cargo run --release -- check -r -Vvbomu -d screaming_snake_case -f pascal_snake_case -f snake_case symbols/*.yml
+cargo run --release -- check -r --cache target/resymgen-cache -Vvbomu -d screaming_snake_case -f pascal_snake_case -f snake_case symbols/*.yml
 cargo run --release -- fmt -r symbols/*.yml
 
@@ -8,15 +8,24 @@
 #
 # By default, this script edits header files in-place. It's recommended that
 # you commit any header file changes before running this script.
+#
+# With --incremental, the content hashes of each header's inputs (the header
+# itself and its symbol file) are recorded, and headers whose inputs haven't
+# changed since the last incremental run are skipped. Headers that do need to be
+# regenerated are formatted together at the end, in a few parallel clang-format
+# invocations rather than one per file per step.
 
 from abc import ABC
 import argparse
+from concurrent.futures import ThreadPoolExecutor
 import fnmatch
+import hashlib
+import json
 import os
 import re
 import subprocess
 import textwrap
-from typing import Dict, Iterator, List, Optional, Set, Tuple
+from typing import Any, Dict, Iterator, List, Optional, Set, Tuple
 import yaml
 
 from symbol_check import (
@@ -26,6 +35,8 @@ from symbol_check import (
     ROOT_DIR,
 )
 
+INCREMENTAL_CACHE_FILE = os.path.join(ROOT_DIR, "headers", ".augment_headers_cache.json")
+
 
 class Formatter(ABC):
     def format_docstring(self, text: str) -> str:
@@ -34,6 +45,10 @@ class Formatter(ABC):
     def format_file(self, filename: str):
         raise NotImplementedError
 
+    def format_files(self, filenames: List[str], jobs: int = 1):
+        for filename in filenames:
+            self.format_file(filename)
+
     def sanitize_comment(self, comment: str) -> str:
         # Break up any end-of-comment delimiters in the raw comment text
         return comment.replace("*/", "* /")
@@ -54,6 +69,18 @@ class ClangFormatFormatter(Formatter):
     def format_file(self, filename: str):
         subprocess.run(["clang-format", "-i", filename], check=True)
 
+    def format_files(self, filenames: List[str], jobs: int = 1):
+        # clang-format accepts many files at once, so split the files evenly
+        # between one invocation per job
+        jobs = max(1, min(jobs, len(filenames)))
+        chunks = [filenames[i::jobs] for i in range(jobs) if filenames[i::jobs]]
+        with ThreadPoolExecutor(max_workers=jobs) as executor:
+            for _ in executor.map(
+                lambda chunk: subprocess.run(["clang-format", "-i"] + chunk, check=True),
+                chunks,
+            ):
+                pass
+
 
 class TextWrapFormatter(Formatter):
     """Fallback formatter if clang-format isn't found in the environment"""
@@ -104,11 +131,14 @@ class HeaderAugmenter:
         *,
         extension: str = "",
         formatter: Optional[Formatter] = None,
+        defer_formatting: bool = False,
     ):
         self.slist = symbol_list
         self.in_extension = ""
         self.out_extension = extension
         self.formatter = formatter if formatter is not None else TextWrapFormatter()
+        # If set, the caller is responsible for formatting the output file
+        self.defer_formatting = defer_formatting
         # Parse symbol aliases and descriptions from the YAML symbol table
         with open(symbol_list.symbol_file, "r") as f:
             symbol_table = yaml.safe_load(f)
@@ -130,7 +160,7 @@ class HeaderAugmenter:
         return self.slist.header_file + self.out_extension
 
     def commit_header_file(self, format: bool = True):
-        if format:
+        if format and not self.defer_formatting:
             self.formatter.format_file(self.output_header_file())
         self.in_extension = self.out_extension
 
@@ -306,6 +336,69 @@ class HeaderAugmenter:
         return add_count
 
 
+class IncrementalCache:
+    """
+    Content hashes of the inputs and outputs of each header from previous
+    incremental runs. A header is up to date if neither its inputs (the header
+    and its symbol file) nor its output have changed since it was last
+    augmented with the same options.
+    """
+
+    def __init__(self, path: str, options: Dict[str, Any]):
+        self.path = path
+        # Changing the script itself can change the output, so treat it like
+        # an option
+        options = dict(options, script=self.digest([__file__]))
+        self.options = json.dumps(options, sort_keys=True)
+        # {output file -> {"input": input digest, "output": output digest}}
+        self.entries: Dict[str, Dict[str, Optional[str]]] = {}
+        try:
+            with open(path, "r") as f:
+                cache = json.load(f)
+            if cache.get("options") == self.options:
+                self.entries = cache["headers"]
+        except (OSError, ValueError, KeyError):
+            # Missing or invalid cache; start from scratch
+            pass
+
+    def save(self):
+        with open(self.path, "w") as f:
+            json.dump({"options": self.options, "headers": self.entries}, f, indent=2)
+
+    @staticmethod
+    def digest(files: List[str]) -> Optional[str]:
+        h = hashlib.sha256()
+        for fname in files:
+            try:
+                with open(fname, "rb") as f:
+                    contents = f.read()
+            except FileNotFoundError:
+                return None
+            # Length-prefix each file so that file boundaries are unambiguous
+            h.update(len(contents).to_bytes(8, "little"))
+            h.update(contents)
+        return h.hexdigest()
+
+    @staticmethod
+    def input_digest(slist: HeaderSymbolList) -> Optional[str]:
+        return IncrementalCache.digest([slist.header_file, slist.symbol_file])
+
+    def is_up_to_date(self, slist: HeaderSymbolList, output_file: str) -> bool:
+        entry = self.entries.get(output_file)
+        return (
+            entry is not None
+            and entry["input"] == self.input_digest(slist)
+            and entry["output"] == self.digest([output_file])
+        )
+
+    def update(self, slist: HeaderSymbolList, output_file: str):
+        """Record the current inputs and output of a header."""
+        self.entries[output_file] = {
+            "input": self.input_digest(slist),
+            "output": self.digest([output_file]),
+        }
+
+
 def add_header_content(
     symbol_list_cls: HeaderSymbolList,
     extension: str,
@@ -316,17 +409,36 @@ def add_header_content(
     formatter: Optional[Formatter] = None,
     filter: Optional[str] = None,
     verbosity: int = 0,
-):
+    cache: Optional[IncrementalCache] = None,
+) -> List[HeaderSymbolList]:
+    """
+    Augment all the headers for the given symbol list type.
+
+    If a cache is given, headers that are up to date are skipped, and the
+    other headers are left unformatted for the caller to format in bulk.
+
+    Returns the symbol lists of the headers that were augmented.
+    """
+    augmented: List[HeaderSymbolList] = []
     for header_file in symbol_list_cls.headers():
         if filter is not None and not fnmatch.fnmatch(header_file, filter):
             continue
         try:
-            augmenter = HeaderAugmenter(
-                symbol_list_cls(header_file), extension=extension, formatter=formatter
-            )
+            slist = symbol_list_cls(header_file)
         except ValueError:
             # File doesn't correspond to a symbol file; skip
             continue
+        if cache is not None and cache.is_up_to_date(slist, header_file + extension):
+            if verbosity >= 2:
+                print(f"Skipping up-to-date {header_file}")
+            continue
+        augmenter = HeaderAugmenter(
+            slist,
+            extension=extension,
+            formatter=formatter,
+            defer_formatting=cache is not None,
+        )
+        augmented.append(slist)
 
         if aliases:
             count = augmenter.add_aliases(mark_aliases_as_deprecated)
@@ -341,6 +453,7 @@ def add_header_content(
             count = augmenter.add_docstrings()
             if verbosity >= 2 or (verbosity >= 1 and count > 0):
                 print(f"Added {count} docstring(s) to {header_file}")
+    return augmented
 
 
 if __name__ == "__main__":
@@ -375,6 +488,19 @@ if __name__ == "__main__":
         "--filter",
         help="Unix filename path filter for header files to process",
     )
+    parser.add_argument(
+        "-i",
+        "--incremental",
+        action="store_true",
+        help="skip header files whose inputs haven't changed since the last incremental run",
+    )
+    parser.add_argument(
+        "-j",
+        "--jobs",
+        type=int,
+        default=os.cpu_count() or 1,
+        help="number of parallel formatting jobs with --incremental",
+    )
     parser.add_argument(
         "-v", "--verbose", action="count", default=0, help="verbosity level"
     )
@@ -393,7 +519,21 @@ if __name__ == "__main__":
                 + f"using textwrap for formatting (linewidth={formatter.linewidth})"
             )
 
-    add_header_content(
+    cache = None
+    if args.incremental:
+        cache = IncrementalCache(
+            INCREMENTAL_CACHE_FILE,
+            {
+                "aliases": args.aliases,
+                "deprecate_aliases": args.deprecate_aliases,
+                "docstrings": args.docstrings,
+                "extension": args.extension,
+                "formatter": type(formatter).__name__,
+                "linewidth": getattr(formatter, "linewidth", None),
+            },
+        )
+
+    augmented = add_header_content(
         FunctionList,
         args.extension,
         aliases=args.aliases,
@@ -402,8 +542,9 @@ if __name__ == "__main__":
         formatter=formatter,
         filter=args.filter,
         verbosity=args.verbose,
+        cache=cache,
     )
-    add_header_content(
+    augmented += add_header_content(
         DataList,
         args.extension,
         aliases=args.aliases,
@@ -412,4 +553,14 @@ if __name__ == "__main__":
         formatter=formatter,
         filter=args.filter,
         verbosity=args.verbose,
+        cache=cache,
     )
+
+    if cache is not None:
+        output_files = [slist.header_file + args.extension for slist in augmented]
+        formatter.format_files(output_files, jobs=args.jobs)
+        for slist, output_file in zip(augmented, output_files):
+            cache.update(slist, output_file)
+        cache.save()
+        if args.verbose:
+            print(f"Regenerated {len(augmented)} header file(s)")
@@ -17,7 +17,7 @@ void InitMemAllocTable(void);
 void SetMemAllocatorParams(get_alloc_arena_fn_t get_alloc_arena,
                            get_free_arena_fn_t get_free_arena);
 struct mem_arena* GetAllocArenaDefault(struct mem_arena* arena, uint32_t flags);
-struct mem_arena* GetFreeArenaDefault(struct mem_arena* arena, uint32_t flags);
+struct mem_arena* GetFreeArenaDefault(struct mem_arena* arena, void* ptr);
 void InitMemArena(struct mem_arena* arena, struct iovec* mem, struct mem_block* blocks,
                   uint32_t max_blocks);
 uint32_t MemAllocFlagsToBlockType(uint32_t alloc_flags);
@@ -479,17 +479,19 @@ void Render3d64Rectangle(struct render_3d_element_64* element64);
 void Render3d64Nothing(struct render_3d_element_64* element64);
 void Render3d64Texture(struct render_3d_element_64* element64);
 void Render3dElement64(struct render_3d_element_64* element64);
-int HandleSir0Translation(uint8_t** dst, uint8_t* src);
-void ConvertPointersSir0(undefined* sir0_ptr);
-int HandleSir0TranslationVeneer(uint8_t** dst, uint8_t* src);
-int DecompressAtNormalVeneer(undefined* addr_decomp, int expected_size, undefined* at_ptr);
-int DecompressAtNormal(undefined* addr_decomp, int expected_size, undefined* at_ptr);
-int DecompressAtHalf(undefined* addr_decomp, int expected_size, undefined* at_ptr, int high_nibble);
+int HandleSir0Translation(uint8_t** dst, struct sir0_header* src);
+void ConvertPointersSir0(struct sir0_header* sir0_ptr);
+int HandleSir0TranslationVeneer(uint8_t** dst, struct sir0_header* src);
+int DecompressAtNormalVeneer(undefined* addr_decomp, int expected_size, struct at_header* at_ptr);
+int DecompressAtNormal(undefined* addr_decomp, int expected_size, struct at_header* at_ptr);
+int DecompressAtHalf(undefined* addr_decomp, int expected_size, struct at_header* at_ptr,
+                     int high_nibble);
 int DecompressAtFromMemoryPointerVeneer(undefined* addr_decomp, int expected_size,
-                                        undefined* at_ptr);
-int DecompressAtFromMemoryPointer(undefined* addr_decomp, int expected_size, undefined* at_ptr);
+                                        struct at_header* at_ptr);
+int DecompressAtFromMemoryPointer(undefined* addr_decomp, int expected_size,
+                                  struct at_header* at_ptr);
 void WriteByteFromMemoryPointer(uint8_t byte);
-int GetAtSize(undefined* at_ptr, int param_2);
+int GetAtSize(struct at_header* at_ptr, int param_2);
 int GetLanguageType(void);
 int GetLanguage(void);
 bool StrcmpTag(const char* s1, const char* s2);
@@ -733,8 +735,8 @@ void ReadStringSave(char* buf);
 bool CheckStringSave(const char* buf);
 int WriteSaveFile(undefined* save_info, undefined* buf, int size);
 int ReadSaveFile(undefined* save_info, undefined* buf, int size);
-void CalcChecksum(undefined* save_info, int size);
-bool CheckChecksumInvalid(undefined* save_info, int size);
+void CalcChecksum(void* buf, int size);
+bool CheckChecksumInvalid(void* buf, int size);
 int NoteSaveBase(int param_1);
 void WriteQuickSaveInfo(undefined* buf, int size);
 undefined4 ReadSaveHeader(undefined4* param_1, undefined4 param_2, undefined4 param_3,
@@ -2,8 +2,8 @@
 #define HEADERS_FUNCTIONS_OVERLAY11_H_
 
 void UnlockScriptingLock(int lock_id);
-void FuncThatCallsRunNextOpcode(undefined* script_engine_state);
-void RunNextOpcode(undefined* script_engine_state);
+void FuncThatCallsRunNextOpcode(struct script_engine_state* script_engine_state);
+void RunNextOpcode(struct script_engine_state* script_engine_state);
 void HandleUnlocks(void);
 void LoadFileFromRomVeneer(struct iovec* iov, const char* filepath, uint32_t flags);
 void SsbLoad2(void);
@@ -23,7 +23,7 @@ bool GetRandomNpcJobStillAvailable(void);
 bool AcceptRandomNpcJob(void);
 int GroundMainLoop(int mode);
 struct mem_arena* GetAllocArenaGround(struct mem_arena* arena, uint32_t flags);
-struct mem_arena* GetFreeArenaGround(struct mem_arena* arena, uint32_t flags);
+struct mem_arena* GetFreeArenaGround(struct mem_arena* arena, void* ptr);
 void GroundMainReturnDungeon(void);
 void GroundMainNextDay(void);
 bool JumpToTitleScreen(int arg);
@@ -0,0 +1,243 @@
+#!/usr/bin/env python3
+
+# Script to generate Ghidra type dumps from the layout database (see
+# layout_db.py), one per version, for import with
+# tools/ghidra_scripts/import_types_json.py.
+#
+# Importing types this way skips Ghidra's C parser entirely. All the work of
+# resolving type names is done here, so the import script only has to create
+# the types, which takes seconds.
+#
+# Each dump is a JSON object of the form:
+# {
+#   "version": <version name>,
+#   "enums": [{"name": <name>, "size": <size>, "values": [[<name>, <value>], ...]}],
+#   "composites": [
+#     {
+#       "name": <name>,
+#       "kind": "struct" | "union",
+#       "size": <size in bytes>,
+#       "fields": [
+#         {
+#           "name": <field name>,
+#           "offset": <byte offset>,
+#           "type": <type reference>,
+#           # Only for bitfields. "offset" is the byte containing the first
+#           # bit, and "bit_offset" is relative to that byte.
+#           "bit_offset": <bit offset>,
+#           "bit_size": <bit size>,
+#           "byte_width": <number of bytes spanned by the bitfield>,
+#         },
+#         ...
+#       ]
+#     },
+#     ...
+#   ],
+#   # In dependency order
+#   "typedefs": [{"name": <name>, "type": <type reference>}, ...]
+# }
+# where a type reference is one of:
+# - {"name": <name>}, for an enum, composite, or typedef in the dump
+# - {"builtin": <name>}, for one of the builtin types in BUILTIN_TYPES
+# - {"pointer": <type reference>}
+# - {"array": <type reference>, "count": <element count>}
+#
+# Types are named like they are by Ghidra's C parser, without a "struct",
+# "union" or "enum" prefix. Anonymous struct and union members become
+# composites of their own, named after the enclosing type and the member's
+# offset. Incomplete types are empty composites with a size of 0.
+
+import argparse
+import json
+import os
+import re
+from typing import Any, Dict, List, Optional, Set
+
+# The C base types used by the headers, and the Ghidra builtin types they map
+# to. As in the headers, types are sized for a 32-bit target.
+BUILTIN_TYPES = {
+    "void": "void",
+    "char": "char",
+    "signed char": "sint1",
+    "unsigned char": "uint1",
+    "short int": "sint2",
+    "short unsigned int": "uint2",
+    "int": "sint4",
+    "unsigned int": "uint4",
+    "long int": "sint4",
+    "long unsigned int": "uint4",
+    "long long int": "sint8",
+    "long long unsigned int": "uint8",
+    "_Bool": "bool",
+    "float": "float",
+    "double": "double",
+    "long double": "double",
+    # Function types don't have a signature in the layout database
+    "function": "void",
+}
+
+QUALIFIER_REGEX = re.compile(r"^(?:(?:const|volatile) )+")
+ARRAY_DIM_REGEX = re.compile(r"\[(\d*)\]$")
+
+
+def ghidra_name(layout_name: str) -> str:
+    """Strip the "struct", "union" or "enum" prefix from a type name."""
+    for prefix in ("struct ", "union ", "enum "):
+        if layout_name.startswith(prefix):
+            return layout_name[len(prefix) :]
+    return layout_name
+
+
+def base_type_name(type_name: str) -> str:
+    """Strip qualifiers, pointers and array dimensions from a type name."""
+    type_name = QUALIFIER_REGEX.sub("", type_name)
+    while True:
+        stripped = ARRAY_DIM_REGEX.sub("", type_name).rstrip("*")
+        if stripped == type_name:
+            return type_name
+        type_name = stripped
+
+
+class TypeDumper:
+    """Converts the layout database entries for a version into a type dump."""
+
+    def __init__(self, layouts: Dict[str, Any]):
+        self.types: Dict[str, Any] = layouts["types"]
+        self.typedefs: Dict[str, str] = layouts["typedefs"]
+        self.composites: List[Dict[str, Any]] = []
+        self.incomplete: Set[str] = set()
+
+    def type_ref(self, type_name: str) -> Dict[str, Any]:
+        """Convert a C-style type name from the layout database."""
+        type_name = QUALIFIER_REGEX.sub("", type_name)
+        # Dimensions are listed outermost first, so the last one is innermost
+        dim = ARRAY_DIM_REGEX.search(type_name)
+        if dim:
+            # Flexible array members have no count
+            count = int(dim[1]) if dim[1] else 0
+            return {"array": self.type_ref(type_name[: dim.start()]), "count": count}
+        if type_name.endswith("*"):
+            return {"pointer": self.type_ref(type_name[:-1])}
+        if type_name in self.types or type_name in self.typedefs:
+            return {"name": ghidra_name(type_name)}
+        if type_name in BUILTIN_TYPES:
+            return {"builtin": BUILTIN_TYPES[type_name]}
+        kind = type_name.split(" ", 1)[0]
+        if kind in ("struct", "union"):
+            # Incomplete types, which are only ever used through pointers.
+            # These are left empty.
+            name = ghidra_name(type_name)
+            if name not in self.incomplete:
+                self.incomplete.add(name)
+                self.composites.append(
+                    {"name": name, "kind": kind, "size": 0, "fields": []}
+                )
+            return {"name": name}
+        raise SystemExit(f"error: unknown type '{type_name}'")
+
+    def add_composite(self, name: str, kind: str, size: int, fields: List[Any]):
+        entry: Dict[str, Any] = {"name": name, "kind": kind, "size": size}
+        # Append before converting fields so that enclosing types come before
+        # the anonymous types they contain
+        self.composites.append(entry)
+        entry["fields"] = [self.field(name, f) for f in fields]
+
+    def field(self, parent: str, field: Dict[str, Any]) -> Dict[str, Any]:
+        entry: Dict[str, Any] = {"name": field["name"], "offset": field["offset"]}
+        if "fields" in field:
+            anon_name = f"{parent}_anon_{field['type']}_{field['offset']:#x}"
+            self.add_composite(
+                anon_name, field["type"], field["size"], field["fields"]
+            )
+            entry["type"] = {"name": anon_name}
+        else:
+            entry["type"] = self.type_ref(field["type"])
+        if "bit_size" in field:
+            bit_offset = field["bit_offset"] % 8
+            entry["bit_offset"] = bit_offset
+            entry["bit_size"] = field["bit_size"]
+            entry["byte_width"] = (bit_offset + field["bit_size"] + 7) // 8
+        return entry
+
+    def sorted_typedefs(self) -> List[Dict[str, Any]]:
+        """Order typedefs so that each one comes after the typedefs it uses."""
+        ordered: List[Dict[str, Any]] = []
+        done = set()
+
+        def visit(name: str):
+            if name in done:
+                return
+            done.add(name)
+            target = self.typedefs[name]
+            base = base_type_name(target)
+            if base in self.typedefs:
+                visit(base)
+            if ghidra_name(target) != name:
+                # Skip typedefs of anonymous types, which are listed under
+                # the typedef name already
+                ordered.append({"name": name, "type": self.type_ref(target)})
+
+        for name in self.typedefs:
+            visit(name)
+        return ordered
+
+    def dump(self, version: str) -> Dict[str, Any]:
+        enums: List[Dict[str, Any]] = []
+        for name, entry in self.types.items():
+            if entry["kind"] == "enum":
+                enums.append(
+                    {
+                        "name": ghidra_name(name),
+                        "size": entry["size"],
+                        "values": list(entry["values"].items()),
+                    }
+                )
+            else:
+                self.add_composite(
+                    ghidra_name(name), entry["kind"], entry["size"], entry["fields"]
+                )
+        return {
+            "version": version,
+            "enums": enums,
+            "composites": self.composites,
+            "typedefs": self.sorted_typedefs(),
+        }
+
+
+def dump_types(layout_db: Dict[str, Any], version: str) -> Dict[str, Any]:
+    return TypeDumper(layout_db[version]).dump(version)
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(
+        description="Generate Ghidra type dumps from the layout database"
+    )
+    parser.add_argument("layout_db", help="layout database generated by layout_db.py")
+    parser.add_argument(
+        "-o",
+        "--output-dir",
+        required=True,
+        help="output directory for the type dumps, named pmdsky_types_<version>.json",
+    )
+    parser.add_argument(
+        "-v",
+        "--version",
+        action="append",
+        help="version to generate a dump for (default: every version in the database)",
+    )
+    args = parser.parse_args()
+
+    with open(args.layout_db, "r") as f:
+        db = json.load(f)
+    versions: Optional[List[str]] = args.version
+    if versions is None:
+        versions = list(db)
+    os.makedirs(args.output_dir, exist_ok=True)
+    for version in versions:
+        version = version.upper()
+        if version not in db:
+            raise SystemExit(f"error: version '{version}' is not in the database")
+        path = os.path.join(args.output_dir, f"pmdsky_types_{version.lower()}.json")
+        with open(path, "w") as f:
+            json.dump(dump_types(db, version), f)
+            f.write("\n")
@@ -0,0 +1,200 @@
+// Host implementations of the fixed-point arithmetic routines in the ARM9 binary.
+//
+// Unlike the rest of the headers, this file contains code. It's only included by pmdsky.h if
+// PMDSKY_HOST_FIXED_POINT is defined, and is meant for external tools (like damage simulators)
+// that want to run the game's fixed-point math natively. The intent is to allow applications to
+// do something like:
+// ```
+// #define PMDSKY_UNSIZED_HEADERS
+// #define PMDSKY_HOST_FIXED_POINT
+// #include "pmdsky-debug/headers/pmdsky.h"
+// ```
+//
+// Each Host* function has the same signature as the game function of the same name without the
+// prefix (see the descriptions in the symbol tables), except for HostClampedLn, which takes the
+// natural log table explicitly (see below). Everything is implemented with 32-bit and 64-bit
+// integer arithmetic, without relying on compiler extensions like 128-bit integers or on
+// implementation-defined behavior like right shifts of negative numbers.
+//
+// These are NOT verified to be bit-exact with the game. They're written from the function
+// descriptions, which don't say how inexact results are rounded, so the rounding here is this
+// file's own convention: products are rounded down (towards negative infinity) and quotients are
+// truncated towards zero. Out-of-range results wrap around. The game's routines may round
+// differently (e.g., if the signed routines go through the unsigned ones in sign-magnitude form),
+// and HostIntToFixedPoint64 does a proper conversion rather than reproducing the bugged sign
+// extension of IntToFixedPoint64. Results for exact operations (where the true result is
+// representable) don't depend on any of this.
+
+#ifndef HEADERS_HOST_FIXED_POINT_H_
+#define HEADERS_HOST_FIXED_POINT_H_
+
+// Returns the raw 64-bit value of a fixed-point number (the number multiplied by 2^16).
+static inline int64_t HostFixedPoint64ToRaw(struct fx64_16* x) {
+    return (int64_t)(((uint64_t)(uint32_t)x->upper << 32) | x->lower);
+}
+
+// Sets a fixed-point number from its raw 64-bit value (the number multiplied by 2^16).
+static inline void HostFixedPoint64FromRaw(struct fx64_16* out, int64_t raw) {
+    out->upper = (int32_t)(uint32_t)((uint64_t)raw >> 32);
+    out->lower = (uint32_t)raw;
+}
+
+// Arithmetic right shift, rounding towards negative infinity. 0 <= n < 64.
+static inline int64_t HostShiftRight64(int64_t x, int n) {
+    return x >= 0 ? x >> n : ~(~x >> n);
+}
+
+// Returns bits [16, 80) of the 128-bit product of two unsigned 64-bit integers. *upper is set to
+// the upper 64 bits of the full product, which is needed for signed multiplication.
+static inline uint64_t HostUMul64Shr16(uint64_t x, uint64_t y, uint64_t* upper) {
+    uint64_t x_lo = (uint32_t)x, x_hi = x >> 32;
+    uint64_t y_lo = (uint32_t)y, y_hi = y >> 32;
+    uint64_t lo_lo = x_lo * y_lo;
+    uint64_t hi_lo = x_hi * y_lo;
+    uint64_t lo_hi = x_lo * y_hi;
+    uint64_t hi_hi = x_hi * y_hi;
+    uint64_t mid = (lo_lo >> 32) + (uint32_t)hi_lo + (uint32_t)lo_hi;
+    uint64_t hi = hi_hi + (hi_lo >> 32) + (lo_hi >> 32) + (mid >> 32);
+    uint64_t lo = (mid << 32) | (uint32_t)lo_lo;
+    *upper = hi;
+    return (hi << 48) | (lo >> 16);
+}
+
+// Returns (x << 16) / y for unsigned 64-bit integers, truncated to 64 bits. y must be nonzero.
+static inline uint64_t HostUDiv64Shl16(uint64_t x, uint64_t y) {
+    uint64_t quotient = 0;
+    uint64_t remainder = 0;
+    int i;
+    // Restoring long division over the 80-bit dividend (x << 16)
+    for (i = 79; i >= 0; i--) {
+        uint64_t carry = remainder >> 63;
+        uint64_t bit = i >= 16 ? (x >> (i - 16)) & 1 : 0;
+        remainder = (remainder << 1) | bit;
+        quotient <<= 1;
+        if (carry || remainder >= y) {
+            remainder -= y;
+            quotient |= 1;
+        }
+    }
+    return quotient;
+}
+
+static inline bool HostUFixedPoint64CmpLt(int32_t x_upper, uint32_t x_lower, int32_t y_upper,
+                                          uint32_t y_lower) {
+    if ((uint32_t)x_upper != (uint32_t)y_upper) {
+        return (uint32_t)x_upper < (uint32_t)y_upper;
+    }
+    return x_lower < y_lower;
+}
+
+static inline int HostMultiplyByFixedPoint(int x, fx32_8 mult_fp) {
+    return (int)(int32_t)(uint32_t)(uint64_t)HostShiftRight64((int64_t)x * mult_fp, 8);
+}
+
+static inline uint32_t HostUMultiplyByFixedPoint(uint32_t x, ufx32_8 mult_fp) {
+    return (uint32_t)(((uint64_t)x * mult_fp) >> 8);
+}
+
+static inline void HostIntToFixedPoint64(struct fx64_16* out, int x) {
+    HostFixedPoint64FromRaw(out, (int64_t)((uint64_t)(int64_t)x << 16));
+}
+
+static inline int HostFixedPoint64ToInt(struct fx64_16* x) {
+    return (int)(int32_t)(uint32_t)((uint64_t)HostFixedPoint64ToRaw(x) >> 16);
+}
+
+static inline void HostFixedPoint32To64(struct fx64_16* out, fx32_8 x_fp) {
+    HostFixedPoint64FromRaw(out, (int64_t)((uint64_t)(int64_t)x_fp << 8));
+}
+
+static inline void HostNegateFixedPoint64(struct fx64_16* x) {
+    HostFixedPoint64FromRaw(x, (int64_t)(0 - (uint64_t)HostFixedPoint64ToRaw(x)));
+}
+
+static inline bool HostFixedPoint64IsZero(struct fx64_16* x) {
+    return x->upper == 0 && x->lower == 0;
+}
+
+static inline bool HostFixedPoint64IsNegative(struct fx64_16* x) {
+    return x->upper < 0;
+}
+
+static inline bool HostFixedPoint64CmpLt(struct fx64_16* x, struct fx64_16* y) {
+    return HostFixedPoint64ToRaw(x) < HostFixedPoint64ToRaw(y);
+}
+
+static inline void HostMultiplyFixedPoint64(struct fx64_16* prod, struct fx64_16* x,
+                                            struct fx64_16* y) {
+    int64_t x_raw = HostFixedPoint64ToRaw(x);
+    int64_t y_raw = HostFixedPoint64ToRaw(y);
+    uint64_t upper;
+    uint64_t result = HostUMul64Shr16((uint64_t)x_raw, (uint64_t)y_raw, &upper);
+    // Correct the unsigned product of the two's complement representations into the signed product
+    // by subtracting (y << 64) if x < 0 and (x << 64) if y < 0. Only the bits of the upper half
+    // that end up in the result (bits [64, 80) of the product) are affected.
+    if (x_raw < 0) {
+        upper -= (uint64_t)y_raw;
+    }
+    if (y_raw < 0) {
+        upper -= (uint64_t)x_raw;
+    }
+    result = (upper << 48) | (result & 0xFFFFFFFFFFFFull);
+    HostFixedPoint64FromRaw(prod, (int64_t)result);
+}
+
+static inline void HostDivideFixedPoint64(struct fx64_16* quotient, struct fx64_16* dividend,
+                                          struct fx64_16* divisor) {
+    int64_t x_raw = HostFixedPoint64ToRaw(dividend);
+    int64_t y_raw = HostFixedPoint64ToRaw(divisor);
+    uint64_t x_mag = x_raw < 0 ? 0 - (uint64_t)x_raw : (uint64_t)x_raw;
+    uint64_t y_mag = y_raw < 0 ? 0 - (uint64_t)y_raw : (uint64_t)y_raw;
+    uint64_t result;
+    if (y_raw == 0) {
+        HostFixedPoint64FromRaw(quotient, 0x7FFFFFFFFFFFFFFFll);
+        return;
+    }
+    result = HostUDiv64Shl16(x_mag, y_mag);
+    if ((x_raw < 0) != (y_raw < 0)) {
+        result = 0 - result;
+    }
+    HostFixedPoint64FromRaw(quotient, (int64_t)result);
+}
+
+static inline void HostUMultiplyFixedPoint64(struct fx64_16* prod, struct fx64_16* x,
+                                             struct fx64_16* y) {
+    uint64_t upper;
+    HostFixedPoint64FromRaw(prod, (int64_t)HostUMul64Shr16((uint64_t)HostFixedPoint64ToRaw(x),
+                                                           (uint64_t)HostFixedPoint64ToRaw(y),
+                                                           &upper));
+}
+
+static inline void HostUDivideFixedPoint64(struct fx64_16* quotient, struct fx64_16* dividend,
+                                           struct fx64_16* divisor) {
+    uint64_t y = (uint64_t)HostFixedPoint64ToRaw(divisor);
+    if (y == 0) {
+        HostFixedPoint64FromRaw(quotient, 0x7FFFFFFFFFFFFFFFll);
+        return;
+    }
+    HostFixedPoint64FromRaw(
+        quotient, (int64_t)HostUDiv64Shl16((uint64_t)HostFixedPoint64ToRaw(dividend), y));
+}
+
+static inline void HostAddFixedPoint64(struct fx64_16* sum, struct fx64_16* x, struct fx64_16* y) {
+    HostFixedPoint64FromRaw(
+        sum, (int64_t)((uint64_t)HostFixedPoint64ToRaw(x) + (uint64_t)HostFixedPoint64ToRaw(y)));
+}
+
+// Same as ClampedLn, with the natural log table passed in explicitly. ln_table must hold the 2048
+// entries of NATURAL_LOG_VALUE_TABLE (e.g., read from an ARM9 binary), and the input is clamped to
+// [1, 2047] (see LOG_MAX_ARG) before the lookup. The result is exact, since the conversion from
+// 12 to 16 fraction bits is lossless.
+static inline void HostClampedLn(struct fx64_16* out, int x, const fx16_12* ln_table) {
+    if (x < 1) {
+        x = 1;
+    } else if (x > 2047) {
+        x = 2047;
+    }
+    HostFixedPoint64FromRaw(out, (int64_t)ln_table[x] * 16);
+}
+
+#endif
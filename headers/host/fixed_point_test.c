@@ -0,0 +1,209 @@
+// Tests for host/fixed_point.h. Run with `make host-test`.
+//
+// The vectors only cover exact results, which follow from the descriptions of the corresponding
+// game functions (and the constants in the symbol tables) regardless of rounding. They haven't
+// been checked against the game itself, and inexact results aren't tested here since their
+// rounding is only a convention of host/fixed_point.h (see the comment there).
+
+#define PMDSKY_UNSIZED_HEADERS
+#define PMDSKY_HOST_FIXED_POINT
+#include "../pmdsky.h"
+
+#include <stdio.h>
+
+static int failures = 0;
+
+#define CHECK_EQ(actual, expected)                                                                 \
+    do {                                                                                           \
+        long long actual_ = (long long)(actual);                                                   \
+        long long expected_ = (long long)(expected);                                               \
+        if (actual_ != expected_) {                                                                \
+            printf("%s:%d: %s == 0x%llX, expected 0x%llX\n", __FILE__, __LINE__, #actual,          \
+                   (unsigned long long)actual_, (unsigned long long)expected_);                     \
+            failures++;                                                                            \
+        }                                                                                          \
+    } while (0)
+
+static struct fx64_16 fx(int64_t raw) {
+    struct fx64_16 x;
+    HostFixedPoint64FromRaw(&x, raw);
+    return x;
+}
+
+static void test_conversions(void) {
+    struct fx64_16 x;
+
+    x = fx(0x123456789ABCDEF0ll);
+    CHECK_EQ(x.upper, 0x12345678);
+    CHECK_EQ(x.lower, 0x9ABCDEF0u);
+    CHECK_EQ(HostFixedPoint64ToRaw(&x), 0x123456789ABCDEF0ll);
+
+    HostIntToFixedPoint64(&x, 999);
+    CHECK_EQ(HostFixedPoint64ToRaw(&x), 999ll << 16);
+
+    // 0x166 is MATCHUP_SUPER_EFFECTIVE_MULTIPLIER
+    HostFixedPoint32To64(&x, 0x166);
+    CHECK_EQ(HostFixedPoint64ToRaw(&x), 0x16600);
+    HostFixedPoint32To64(&x, -0x180);
+    CHECK_EQ(HostFixedPoint64ToRaw(&x), -0x18000);
+
+    x = fx(0x18000); // 1.5
+    CHECK_EQ(HostFixedPoint64ToInt(&x), 1);
+}
+
+static void test_32_bit(void) {
+    CHECK_EQ(HostMultiplyByFixedPoint(100, 0x180), 150);
+    CHECK_EQ(HostMultiplyByFixedPoint(-100, 0x180), -150);
+    CHECK_EQ(HostMultiplyByFixedPoint(0x7FFFFFFF, 0x100), 0x7FFFFFFF);
+    CHECK_EQ(HostUMultiplyByFixedPoint(100, 0x40), 25);
+    CHECK_EQ(HostUMultiplyByFixedPoint(0xFFFFFFFFu, 0x100), 0xFFFFFFFFu);
+}
+
+static void test_64_bit(void) {
+    struct fx64_16 x, y, z;
+
+    x = fx(0x18000); // 1.5
+    HostNegateFixedPoint64(&x);
+    CHECK_EQ(HostFixedPoint64ToRaw(&x), -0x18000);
+    CHECK_EQ(HostFixedPoint64IsNegative(&x), 1);
+    CHECK_EQ(HostFixedPoint64IsZero(&x), 0);
+    x = fx(0);
+    CHECK_EQ(HostFixedPoint64IsZero(&x), 1);
+    CHECK_EQ(HostFixedPoint64IsNegative(&x), 0);
+
+    x = fx(-1);
+    y = fx(1);
+    CHECK_EQ(HostFixedPoint64CmpLt(&x, &y), 1);
+    CHECK_EQ(HostFixedPoint64CmpLt(&y, &x), 0);
+    CHECK_EQ(HostUFixedPoint64CmpLt(x.upper, x.lower, y.upper, y.lower), 0);
+    CHECK_EQ(HostUFixedPoint64CmpLt(y.upper, y.lower, x.upper, x.lower), 1);
+
+    x = fx(0x18000);
+    y = fx(-0x28000);
+    HostAddFixedPoint64(&z, &x, &y);
+    CHECK_EQ(HostFixedPoint64ToRaw(&z), -0x10000);
+
+    // Multiplication
+    x = fx(0x18000); // 1.5
+    y = fx(0x20000); // 2
+    HostMultiplyFixedPoint64(&z, &x, &y);
+    CHECK_EQ(HostFixedPoint64ToRaw(&z), 0x30000);
+    y = fx(-0x20000); // -2
+    HostMultiplyFixedPoint64(&z, &x, &y);
+    CHECK_EQ(HostFixedPoint64ToRaw(&z), -0x30000);
+    x = fx(-0x18000);
+    HostMultiplyFixedPoint64(&z, &x, &y);
+    CHECK_EQ(HostFixedPoint64ToRaw(&z), 0x30000);
+    x = fx(1ll << 36); // 2^20
+    y = fx(1ll << 36);
+    HostMultiplyFixedPoint64(&z, &x, &y);
+    CHECK_EQ(HostFixedPoint64ToRaw(&z), 1ll << 56);
+    y = fx(-(1ll << 36));
+    HostMultiplyFixedPoint64(&z, &x, &y);
+    CHECK_EQ(HostFixedPoint64ToRaw(&z), -(1ll << 56));
+    x = fx(0x180000000ll);
+    y = fx(0x180000000ll);
+    HostUMultiplyFixedPoint64(&z, &x, &y);
+    CHECK_EQ(HostFixedPoint64ToRaw(&z), 0x2400000000000ll);
+
+    // Division
+    x = fx(0x30000); // 3
+    y = fx(0x20000); // 2
+    HostDivideFixedPoint64(&z, &x, &y);
+    CHECK_EQ(HostFixedPoint64ToRaw(&z), 0x18000);
+    y = fx(-0x20000);
+    HostDivideFixedPoint64(&z, &x, &y);
+    CHECK_EQ(HostFixedPoint64ToRaw(&z), -0x18000);
+    // 85/64 is DAMAGE_FORMULA_NON_TEAM_MEMBER_MODIFIER
+    x = fx(85ll << 16);
+    y = fx(64ll << 16);
+    HostUDivideFixedPoint64(&z, &x, &y);
+    CHECK_EQ(HostFixedPoint64ToRaw(&z), 0x15400);
+    y = fx(0);
+    HostDivideFixedPoint64(&z, &x, &y);
+    CHECK_EQ(z.upper, 0x7FFFFFFF);
+    CHECK_EQ(z.lower, 0xFFFFFFFFu);
+    HostUDivideFixedPoint64(&z, &x, &y);
+    CHECK_EQ(z.upper, 0x7FFFFFFF);
+    CHECK_EQ(z.lower, 0xFFFFFFFFu);
+}
+
+static void test_clamped_ln(void) {
+    static fx16_12 ln_table[2048];
+    struct fx64_16 x;
+    int i;
+
+    for (i = 0; i < 2048; i++) {
+        ln_table[i] = (fx16_12)(i * 8);
+    }
+    HostClampedLn(&x, 100, ln_table);
+    CHECK_EQ(HostFixedPoint64ToRaw(&x), 800 * 16);
+    HostClampedLn(&x, 0, ln_table);
+    CHECK_EQ(HostFixedPoint64ToRaw(&x), 8 * 16);
+    HostClampedLn(&x, -5, ln_table);
+    CHECK_EQ(HostFixedPoint64ToRaw(&x), 8 * 16);
+    HostClampedLn(&x, 5000, ln_table);
+    CHECK_EQ(HostFixedPoint64ToRaw(&x), 2047 * 8 * 16);
+}
+
+#ifdef __SIZEOF_INT128__
+// Compare the portable 64-bit kernels against 128-bit reference arithmetic on pseudorandom
+// inputs. This only checks that the kernels implement the rounding conventions of
+// host/fixed_point.h correctly; it says nothing about how the game rounds.
+static void test_against_int128(void) {
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+    int initial_failures = failures;
+    int i;
+
+    for (i = 0; i < 100000; i++) {
+        struct fx64_16 x, y, z;
+        int64_t a, b;
+        __int128 expected;
+
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        a = (int64_t)state >> (state & 31);
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        b = (int64_t)state >> (state & 31);
+        x = fx(a);
+        y = fx(b);
+
+        HostMultiplyFixedPoint64(&z, &x, &y);
+        expected = ((__int128)a * b) >> 16;
+        CHECK_EQ(HostFixedPoint64ToRaw(&z), (int64_t)(uint64_t)expected);
+
+        HostUMultiplyFixedPoint64(&z, &x, &y);
+        expected = (__int128)(((unsigned __int128)(uint64_t)a * (uint64_t)b) >> 16);
+        CHECK_EQ(HostFixedPoint64ToRaw(&z), (int64_t)(uint64_t)expected);
+
+        if (b != 0) {
+            HostDivideFixedPoint64(&z, &x, &y);
+            expected = ((__int128)a * 65536) / b;
+            CHECK_EQ(HostFixedPoint64ToRaw(&z), (int64_t)(uint64_t)expected);
+
+            HostUDivideFixedPoint64(&z, &x, &y);
+            expected = (__int128)(((unsigned __int128)(uint64_t)a << 16) / (uint64_t)b);
+            CHECK_EQ(HostFixedPoint64ToRaw(&z), (int64_t)(uint64_t)expected);
+        }
+        if (failures > initial_failures) {
+            printf("inputs: 0x%llX, 0x%llX\n", (unsigned long long)a, (unsigned long long)b);
+            return;
+        }
+    }
+}
+#endif
+
+int main(void) {
+    test_conversions();
+    test_32_bit();
+    test_64_bit();
+    test_clamped_ln();
+#ifdef __SIZEOF_INT128__
+    test_against_int128();
+#endif
+    if (failures > 0) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("All checks passed\n");
+    return 0;
+}
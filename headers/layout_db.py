@@ -0,0 +1,365 @@
+#!/usr/bin/env python3
+
+# Script to generate a machine-readable database of the type layouts defined in
+# the C headers, for tools that need to read game memory without parsing C.
+#
+# Layouts are taken straight from the compiler via the DWARF debug info of the
+# headers compiled as an object file (see the `layout-db` target in the
+# Makefile), so they reflect exactly what the compiler computed. The sizes are
+# cross-checked against the ASSERT_SIZE assertions in the preprocessed headers.
+#
+# Reading the debug info requires `readelf` from GNU Binutils.
+#
+# The output is a JSON object of the form:
+# {
+#   "<version>": {
+#     "types": {
+#       "struct <name>": {
+#         "kind": "struct",
+#         "size": <size in bytes>,
+#         "asserted": <whether the size is constrained by ASSERT_SIZE>,
+#         "fields": [
+#           {
+#             "name": <field name, or null for anonymous members>,
+#             "offset": <byte offset>,
+#             "size": <size in bytes>,
+#             "type": <C type name>,
+#             # Only for bitfields, in bits from the start of the struct.
+#             # "offset" is the byte containing the first bit.
+#             "bit_offset": <bit offset>,
+#             "bit_size": <bit size>,
+#             # Only for anonymous struct and union types, which aren't
+#             # listed separately
+#             "fields": [...]
+#           },
+#           ...
+#         ]
+#       },
+#       "union <name>": {"kind": "union", ...},
+#       "enum <name>": {"kind": "enum", "size": ..., "values": {<name>: <value>}},
+#       ...
+#     },
+#     "typedefs": {<name>: <C type name>}
+#   }
+# }
+# Anonymous types that are given a name by a typedef are listed under the
+# typedef name.
+
+import argparse
+import json
+import re
+import subprocess
+from typing import Any, Dict, List, Optional, Tuple
+
+DIE_REGEX = re.compile(r"^\s*<(\d+)><([0-9a-f]+)>: Abbrev Number: \d+(?: \((\w+)\))?")
+ATTR_REGEX = re.compile(r"^\s*<[0-9a-f]+>\s+(DW_AT_\w+)\s*: (.*)$")
+# Some versions of readelf prefix attribute values with the attribute form
+FORM_REGEX = re.compile(r"^\((?:\w+|implicit_const)\) ")
+STRING_REGEX = re.compile(r"^\((?:indirect|indexed|offset)[^)]*\): (.*)$")
+REF_REGEX = re.compile(r"^<0x([0-9a-f]+)>")
+ASSERT_REGEX = re.compile(r"_Static_assert\(\s*sizeof\(([^()]+)\)\s*==\s*(\w+)\s*,")
+
+
+class Die:
+    """A debugging information entry from the DWARF debug info."""
+
+    def __init__(self, offset: int, tag: str):
+        self.offset = offset
+        self.tag = tag
+        self.attrs: Dict[str, str] = {}
+        self.children: List["Die"] = []
+
+    def attr(self, attr: str) -> Optional[str]:
+        value = self.attrs.get(attr)
+        if value is None:
+            return None
+        return FORM_REGEX.sub("", value, count=1)
+
+    def name(self) -> Optional[str]:
+        name = self.attr("DW_AT_name")
+        if name is None:
+            return None
+        match = STRING_REGEX.match(name)
+        return match[1] if match else name
+
+    def int_attr(self, attr: str) -> Optional[int]:
+        value = self.attr(attr)
+        if value is None:
+            return None
+        return int(value.split()[0], 0)
+
+    def ref_attr(self, attr: str) -> Optional[int]:
+        value = self.attr(attr)
+        if value is None:
+            return None
+        match = REF_REGEX.match(value)
+        return int(match[1], 16) if match else None
+
+
+def read_dies(object_file: str, readelf: str = "readelf") -> Dict[int, Die]:
+    """Read all the DIEs in an object file, keyed by offset."""
+    output = subprocess.run(
+        [readelf, "--debug-dump=info", object_file],
+        capture_output=True,
+        check=True,
+    ).stdout.decode()
+    dies: Dict[int, Die] = {}
+    # Parents of the current DIE, indexed by depth
+    stack: List[Die] = []
+    current: Optional[Die] = None
+    for line in output.splitlines():
+        die_match = DIE_REGEX.match(line)
+        if die_match:
+            depth = int(die_match[1])
+            del stack[depth:]
+            if die_match[3] is None:
+                # Null entry marking the end of a list of children
+                current = None
+                continue
+            current = Die(int(die_match[2], 16), die_match[3])
+            dies[current.offset] = current
+            if stack:
+                stack[-1].children.append(current)
+            stack.append(current)
+            continue
+        attr_match = ATTR_REGEX.match(line)
+        if attr_match and current is not None:
+            current.attrs[attr_match[1]] = attr_match[2].strip()
+    return dies
+
+
+class LayoutBuilder:
+    """Converts DIEs into layout database entries."""
+
+    AGGREGATE_KINDS = {
+        "DW_TAG_structure_type": "struct",
+        "DW_TAG_union_type": "union",
+        "DW_TAG_enumeration_type": "enum",
+    }
+
+    def __init__(self, dies: Dict[int, Die]):
+        self.dies = dies
+        # Names given to anonymous types by typedefs
+        self.typedef_names: Dict[int, str] = {}
+        for die in dies.values():
+            target = die.ref_attr("DW_AT_type")
+            if die.tag == "DW_TAG_typedef" and target is not None:
+                target_die = dies[target]
+                if (
+                    target_die.tag in self.AGGREGATE_KINDS
+                    and target_die.name() is None
+                    and target not in self.typedef_names
+                ):
+                    self.typedef_names[target] = cast_str(die.name())
+
+    def aggregate_name(self, die: Die) -> Optional[str]:
+        name = die.name()
+        if name is not None:
+            return f"{self.AGGREGATE_KINDS[die.tag]} {name}"
+        return self.typedef_names.get(die.offset)
+
+    def type_name(self, offset: Optional[int]) -> str:
+        """Get a C-style name for the type at the given offset."""
+        if offset is None:
+            return "void"
+        die = self.dies[offset]
+        if die.tag in ("DW_TAG_base_type", "DW_TAG_typedef"):
+            return cast_str(die.name())
+        if die.tag in self.AGGREGATE_KINDS:
+            name = self.aggregate_name(die)
+            return name if name is not None else self.AGGREGATE_KINDS[die.tag]
+        if die.tag == "DW_TAG_pointer_type":
+            return self.type_name(die.ref_attr("DW_AT_type")) + "*"
+        if die.tag == "DW_TAG_const_type":
+            return "const " + self.type_name(die.ref_attr("DW_AT_type"))
+        if die.tag == "DW_TAG_volatile_type":
+            return "volatile " + self.type_name(die.ref_attr("DW_AT_type"))
+        if die.tag == "DW_TAG_array_type":
+            dims = "".join(
+                f"[{'' if n is None else n}]" for n in self.array_dims(die)
+            )
+            return self.type_name(die.ref_attr("DW_AT_type")) + dims
+        if die.tag == "DW_TAG_subroutine_type":
+            return "function"
+        return die.tag
+
+    def array_dims(self, die: Die) -> List[Optional[int]]:
+        dims: List[Optional[int]] = []
+        for sub in die.children:
+            if sub.tag != "DW_TAG_subrange_type":
+                continue
+            count = sub.int_attr("DW_AT_count")
+            upper_bound = sub.int_attr("DW_AT_upper_bound")
+            if count is None and upper_bound is not None:
+                count = upper_bound + 1
+            # No bounds means a flexible array member
+            dims.append(count)
+        return dims
+
+    def type_size(self, offset: Optional[int]) -> int:
+        if offset is None:
+            return 0
+        die = self.dies[offset]
+        size = die.int_attr("DW_AT_byte_size")
+        if size is not None:
+            return size
+        if die.tag == "DW_TAG_pointer_type":
+            # Should have a byte size, but just in case. The headers target a
+            # 32-bit architecture.
+            return 4
+        if die.tag == "DW_TAG_array_type":
+            size = self.type_size(die.ref_attr("DW_AT_type"))
+            for n in self.array_dims(die):
+                size *= n if n is not None else 0
+            return size
+        if die.tag in ("DW_TAG_typedef", "DW_TAG_const_type", "DW_TAG_volatile_type"):
+            return self.type_size(die.ref_attr("DW_AT_type"))
+        return 0
+
+    def fields(self, die: Die) -> List[Dict[str, Any]]:
+        fields: List[Dict[str, Any]] = []
+        for member in die.children:
+            if member.tag != "DW_TAG_member":
+                continue
+            type_offset = member.ref_attr("DW_AT_type")
+            size = self.type_size(type_offset)
+            field: Dict[str, Any] = {
+                "name": member.name(),
+                "offset": member.int_attr("DW_AT_data_member_location") or 0,
+                "size": size,
+                "type": self.type_name(type_offset),
+            }
+            bit_size = member.int_attr("DW_AT_bit_size")
+            if bit_size is not None:
+                bit_offset = member.int_attr("DW_AT_data_bit_offset")
+                if bit_offset is None:
+                    # DWARF 2/3-style bitfield, where DW_AT_bit_offset counts
+                    # from the most significant bit of the storage unit. The
+                    # headers target a little-endian architecture.
+                    storage_size = member.int_attr("DW_AT_byte_size") or size
+                    bit_offset = (
+                        field["offset"] * 8
+                        + storage_size * 8
+                        - (member.int_attr("DW_AT_bit_offset") or 0)
+                        - bit_size
+                    )
+                field["offset"] = bit_offset // 8
+                field["bit_offset"] = bit_offset
+                field["bit_size"] = bit_size
+            if type_offset is not None:
+                type_die = self.dies[type_offset]
+                if (
+                    type_die.tag in ("DW_TAG_structure_type", "DW_TAG_union_type")
+                    and self.aggregate_name(type_die) is None
+                ):
+                    field["fields"] = self.fields(type_die)
+            fields.append(field)
+        return fields
+
+    def build(self) -> Dict[str, Any]:
+        types: Dict[str, Any] = {}
+        typedefs: Dict[str, str] = {}
+        for die in self.dies.values():
+            if die.tag == "DW_TAG_typedef":
+                typedefs[cast_str(die.name())] = self.type_name(
+                    die.ref_attr("DW_AT_type")
+                )
+                continue
+            if die.tag not in self.AGGREGATE_KINDS or "DW_AT_declaration" in die.attrs:
+                continue
+            name = self.aggregate_name(die)
+            if name is None:
+                # Anonymous types are inlined where they're used
+                continue
+            kind = self.AGGREGATE_KINDS[die.tag]
+            entry: Dict[str, Any] = {
+                "kind": kind,
+                "size": self.type_size(die.offset),
+            }
+            if kind == "enum":
+                entry["values"] = {
+                    cast_str(e.name()): e.int_attr("DW_AT_const_value")
+                    for e in die.children
+                    if e.tag == "DW_TAG_enumerator"
+                }
+            else:
+                entry["asserted"] = False
+                entry["fields"] = self.fields(die)
+            types[name] = entry
+        return {"types": dict(sorted(types.items())), "typedefs": typedefs}
+
+
+def cast_str(s: Optional[str]) -> str:
+    assert s is not None
+    return s
+
+
+def read_asserted_sizes(preprocessed_file: str) -> List[Tuple[str, int]]:
+    """
+    Find the (type, size) pairs in all the ASSERT_SIZE assertions in a
+    preprocessed header.
+    """
+    with open(preprocessed_file, "r") as f:
+        contents = f.read()
+    return [
+        (" ".join(type_name.split()), int(size, 0))
+        for type_name, size in ASSERT_REGEX.findall(contents)
+    ]
+
+
+def check_asserted_sizes(layouts: Dict[str, Any], asserts: List[Tuple[str, int]]):
+    """
+    Make sure the layouts agree with ASSERT_SIZE, and mark the types that are
+    constrained by it.
+    """
+    for type_name, size in asserts:
+        entry = layouts["types"].get(type_name)
+        if entry is None:
+            # Primitive types and the like
+            continue
+        if entry["size"] != size:
+            raise SystemExit(
+                f"error: {type_name} has size {entry['size']:#x},"
+                + f" but ASSERT_SIZE requires {size:#x}"
+            )
+        if "asserted" in entry:
+            entry["asserted"] = True
+
+
+def build_layout_db(
+    versions: List[Tuple[str, str, str]], readelf: str = "readelf"
+) -> Dict[str, Any]:
+    db: Dict[str, Any] = {}
+    for version, object_file, preprocessed_file in versions:
+        layouts = LayoutBuilder(read_dies(object_file, readelf)).build()
+        check_asserted_sizes(layouts, read_asserted_sizes(preprocessed_file))
+        db[version.upper()] = layouts
+    return db
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(
+        description="Generate a JSON database of the type layouts in the C headers"
+    )
+    parser.add_argument(
+        "--version",
+        nargs=3,
+        action="append",
+        required=True,
+        metavar=("NAME", "OBJECT", "PREPROCESSED"),
+        help="version name, the headers compiled for that version as an object file"
+        + " with debug info, and the preprocessed headers for that version",
+    )
+    parser.add_argument(
+        "-o", "--output", required=True, help="output file for the database"
+    )
+    parser.add_argument("--readelf", default="readelf", help="readelf executable")
+    parser.add_argument(
+        "--pretty", action="store_true", help="indent the output for readability"
+    )
+    args = parser.parse_args()
+
+    db = build_layout_db([tuple(v) for v in args.version], args.readelf)
+    with open(args.output, "w") as f:
+        json.dump(db, f, indent=2 if args.pretty else None)
+        f.write("\n")
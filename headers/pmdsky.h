@@ -144,4 +144,9 @@ typedef undefined1 undefined;
 #include "functions/functions.h"
 #include "data/data.h"
 
+// Optional host implementations of the game's fixed-point arithmetic. See host/fixed_point.h.
+#ifdef PMDSKY_HOST_FIXED_POINT
+#include "host/fixed_point.h"
+#endif
+
 #endif
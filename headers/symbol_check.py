@@ -2,17 +2,55 @@
 
 # Script to check that all function and data symbol names present in the C
 # headers are also present in the symbol tables.
+#
+# The names found in each header and symbol file are cached by content hash in
+# a declaration index, so repeated runs only need to rescan files that have
+# changed.
 
 from abc import ABC
+from concurrent.futures import ProcessPoolExecutor
 import argparse
 import difflib
+import hashlib
+import json
 import os
 import re
-from typing import Dict, Generator, List, Optional
+from typing import Any, Dict, Generator, List, Optional, Set, Tuple, Type
 import yaml
 
 ROOT_DIR = os.path.relpath(os.path.join(os.path.dirname(__file__), ".."))
 SYMBOLS_DIR = os.path.join(ROOT_DIR, "symbols")
+INDEX_CACHE_FILE = os.path.join(ROOT_DIR, "headers", ".symbol_check_cache.json")
+# Use the C YAML bindings if available
+YAML_LOADER = getattr(yaml, "CSafeLoader", yaml.SafeLoader)
+
+# C tokens, for the purposes of finding declarations. Comments, whitespace, and
+# string and character literals are matched so that they can be skipped.
+TOKEN_REGEX = re.compile(
+    r"""
+    (?P<comment>//[^\n]*|/\*.*?(?:\*/|\Z))
+    |(?P<literal>"(?:\\.|[^"\\\n])*"|'(?:\\.|[^'\\\n])*')
+    |(?P<word>\w+)
+    |(?P<space>\s+)
+    |(?P<punct>.)
+    """,
+    re.VERBOSE | re.DOTALL,
+)
+
+# A C token, as (whether the token is a word, token text)
+Token = Tuple[bool, str]
+
+
+def tokenize_c(contents: str) -> List[Token]:
+    """
+    Split C source into word and punctuation tokens, without comments,
+    whitespace, or literals.
+    """
+    return [
+        (m.lastgroup == "word", m.group())
+        for m in TOKEN_REGEX.finditer(contents)
+        if m.lastgroup == "word" or m.lastgroup == "punct"
+    ]
 
 
 class HeaderSymbolList(ABC):
@@ -32,14 +70,16 @@ class HeaderSymbolList(ABC):
     # Caches to avoid doing unnecessary file I/O
     cached_header_names: Optional[List[str]]
     cached_symbol_names: Optional[List[str]]
+    index: Optional["DeclarationIndex"]
 
-    def __init__(self, header_file: str):
+    def __init__(self, header_file: str, index: Optional["DeclarationIndex"] = None):
         assert hasattr(self, "HEADERS_DIR")
         assert hasattr(self, "SYMBOL_LIST_KEY")
         assert hasattr(self, "NAME_REGEX")
 
         self.cached_header_names = None
         self.cached_symbol_names = None
+        self.index = index
         self.header_file = header_file
         symbol_file = self.get_symbol_file(self.header_file)
         if symbol_file is not None:
@@ -72,32 +112,36 @@ class HeaderSymbolList(ABC):
         fname = os.path.join(SYMBOLS_DIR, cls.file_stem(header_file) + ".yml")
         return fname if os.path.isfile(fname) else None
 
-    @staticmethod
-    def header_file_strip_comments(contents: str) -> str:
-        # Remove "//" comments
-        contents = re.sub(r"//[^\n]*\n", "\n", contents)
-        # Remove "/* */" comments
-        contents = re.sub(r"/\*.*?\*/", "", contents, flags=re.DOTALL)
-        return contents
+    @classmethod
+    def names_from_tokens(cls, tokens: List[Token]) -> List[str]:
+        """
+        Find symbol names within a tokenized C header. Equivalent to searching
+        for NAME_REGEX in the header with comments stripped.
+        """
+        raise NotImplementedError
 
     @classmethod
     def names_from_c_header(cls, fpath: str) -> List[str]:
         with open(fpath, "r") as f:
-            return cls.NAME_REGEX.findall(cls.header_file_strip_comments(f.read()))
+            return cls.names_from_tokens(tokenize_c(f.read()))
 
     def names_from_header_file(self) -> List[str]:
         if self.cached_header_names is None:
-            self.cached_header_names = self.names_from_c_header(self.header_file)
+            if self.index is not None:
+                self.cached_header_names = self.index.header_names(
+                    type(self), self.header_file
+                )
+            else:
+                self.cached_header_names = self.names_from_c_header(self.header_file)
         return list(self.cached_header_names)
 
     def names_from_symbol_file(self) -> List[str]:
         if self.cached_symbol_names is None:
-            with open(self.symbol_file, "r") as f:
-                self.cached_symbol_names = [
-                    symbol["name"]
-                    for block in yaml.safe_load(f).values()
-                    for symbol in block[self.SYMBOL_LIST_KEY]
-                ]
+            if self.index is not None:
+                names = self.index.symbol_names(self.symbol_file)
+            else:
+                names = names_from_yaml(self.symbol_file)
+            self.cached_symbol_names = names[self.SYMBOL_LIST_KEY]
         return list(self.cached_symbol_names)
 
     def missing_symbols(self) -> List[str]:
@@ -148,6 +192,14 @@ class FunctionList(HeaderSymbolList):
     # should really be typedef'd for readability anyway.
     NAME_REGEX = re.compile(r"\b(\w+)\s*\(")
 
+    @classmethod
+    def names_from_tokens(cls, tokens: List[Token]) -> List[str]:
+        return [
+            text
+            for (is_word, text), (_, next_text) in zip(tokens, tokens[1:])
+            if is_word and next_text == "("
+        ]
+
 
 class DataList(HeaderSymbolList):
     HEADERS_DIR = os.path.join(ROOT_DIR, "headers", "data")
@@ -162,6 +214,162 @@ class DataList(HeaderSymbolList):
     # these should really be typedef'd for readability anyway.
     NAME_REGEX = re.compile(r"\b(\w+)(?:\s*(?:\)|\[\s*\w+\s*\]))*\s*;")
 
+    @classmethod
+    def names_from_tokens(cls, tokens: List[Token]) -> List[str]:
+        names: List[str] = []
+        n = len(tokens)
+        i = 0
+        while i < n:
+            is_word, text = tokens[i]
+            i += 1
+            if not is_word:
+                continue
+            # Skip past closing parentheses and single-word array sizes
+            j = i
+            while j < n:
+                if tokens[j][1] == ")":
+                    j += 1
+                elif (
+                    tokens[j][1] == "["
+                    and j + 2 < n
+                    and tokens[j + 1][0]
+                    and tokens[j + 2][1] == "]"
+                ):
+                    j += 3
+                else:
+                    break
+            if j < n and tokens[j][1] == ";":
+                names.append(text)
+                # Like regex matches, declarations don't overlap
+                i = j + 1
+        return names
+
+
+def file_digest(fname: str) -> str:
+    with open(fname, "rb") as f:
+        return hashlib.sha256(f.read()).hexdigest()
+
+
+def names_from_yaml(symbol_file: str) -> Dict[str, List[str]]:
+    """
+    Get the names of the symbols in a symbol file, keyed by symbol list key.
+    """
+    with open(symbol_file, "r") as f:
+        symbol_table = yaml.load(f, Loader=YAML_LOADER)
+    return {
+        key: [
+            symbol["name"]
+            for block in symbol_table.values()
+            for symbol in block.get(key, [])
+        ]
+        for key in (FunctionList.SYMBOL_LIST_KEY, DataList.SYMBOL_LIST_KEY)
+    }
+
+
+def _index_file(task: Tuple[Optional[Type[HeaderSymbolList]], str]) -> Any:
+    """Scan a header file or symbol file for its names, for DeclarationIndex."""
+    symbol_list, fname = task
+    if symbol_list is None:
+        return names_from_yaml(fname)
+    return symbol_list.names_from_c_header(fname)
+
+
+class DeclarationIndex:
+    """
+    Names declared in the C headers and symbol files, keyed by file content
+    hash. The index can be persisted to a cache file between runs, in which
+    case only new or modified files need to be scanned.
+    """
+
+    def __init__(self, cache_file: Optional[str] = None):
+        self.cache_file = cache_file
+        # Changing the script can change how files are scanned
+        self.version = file_digest(__file__)
+        # {"<symbol list key>:<digest>" -> header names}
+        self.headers: Dict[str, List[str]] = {}
+        # {digest -> {symbol list key -> symbol names}}
+        self.symbols: Dict[str, Dict[str, List[str]]] = {}
+        # Entries used in this run, to be persisted
+        self.used_headers: Dict[str, List[str]] = {}
+        self.used_symbols: Dict[str, Dict[str, List[str]]] = {}
+        if cache_file is None:
+            return
+        try:
+            with open(cache_file, "r") as f:
+                cache = json.load(f)
+            if cache.get("version") == self.version:
+                self.headers = cache["headers"]
+                self.symbols = cache["symbols"]
+        except (OSError, ValueError, KeyError):
+            # Missing or invalid cache; start from scratch
+            pass
+
+    def save(self):
+        """Persist the entries used since the index was loaded."""
+        if self.cache_file is None:
+            return
+        with open(self.cache_file, "w") as f:
+            json.dump(
+                {
+                    "version": self.version,
+                    "headers": self.used_headers,
+                    "symbols": self.used_symbols,
+                },
+                f,
+            )
+
+    @staticmethod
+    def _header_key(symbol_list: Type[HeaderSymbolList], digest: str) -> str:
+        return f"{symbol_list.SYMBOL_LIST_KEY}:{digest}"
+
+    def header_names(
+        self, symbol_list: Type[HeaderSymbolList], header_file: str
+    ) -> List[str]:
+        key = self._header_key(symbol_list, file_digest(header_file))
+        if key not in self.headers:
+            self.headers[key] = symbol_list.names_from_c_header(header_file)
+        self.used_headers[key] = self.headers[key]
+        return self.headers[key]
+
+    def symbol_names(self, symbol_file: str) -> Dict[str, List[str]]:
+        key = file_digest(symbol_file)
+        if key not in self.symbols:
+            self.symbols[key] = names_from_yaml(symbol_file)
+        self.used_symbols[key] = self.symbols[key]
+        return self.symbols[key]
+
+    def update(self, symbol_lists: List[Type[HeaderSymbolList]], jobs: int = 1):
+        """
+        Make sure all the headers for the given symbol list types and their
+        symbol files are indexed, scanning any missing files in parallel.
+        """
+        tasks: List[Tuple[Optional[Type[HeaderSymbolList]], str]] = []
+        keys: List[Tuple[Dict[str, Any], str]] = []
+        # Symbol files can be shared between symbol list types
+        pending_symbols: Set[str] = set()
+        for symbol_list in symbol_lists:
+            for header_file in symbol_list.headers():
+                symbol_file = symbol_list.get_symbol_file(header_file)
+                if symbol_file is None:
+                    continue
+                key = self._header_key(symbol_list, file_digest(header_file))
+                if key not in self.headers:
+                    tasks.append((symbol_list, header_file))
+                    keys.append((self.headers, key))
+                key = file_digest(symbol_file)
+                if key not in self.symbols and key not in pending_symbols:
+                    tasks.append((None, symbol_file))
+                    keys.append((self.symbols, key))
+                    pending_symbols.add(key)
+
+        if jobs > 1 and len(tasks) > 1:
+            with ProcessPoolExecutor(max_workers=jobs) as executor:
+                results = list(executor.map(_index_file, tasks))
+        else:
+            results = [_index_file(t) for t in tasks]
+        for (entries, key), result in zip(keys, results):
+            entries[key] = result
+
 
 def run_symbol_check(
     symbol_list: HeaderSymbolList,
@@ -169,11 +377,12 @@ def run_symbol_check(
     find_extra_symbols: bool = False,
     check_order: bool = False,
     verbose: bool = False,
+    index: Optional[DeclarationIndex] = None,
 ) -> bool:
     passed = True
     for header_file in symbol_list.headers():
         try:
-            slist = symbol_list(header_file)
+            slist = symbol_list(header_file, index=index)
             missing = slist.missing_symbols()
             extra = slist.extra_symbols() if find_extra_symbols else []
             order_diff = slist.order_diff() if check_order else []
@@ -237,15 +446,30 @@ if __name__ == "__main__":
         action="store_true",
         help="check sort order in the C headers based on symbol table order",
     )
+    parser.add_argument(
+        "-j",
+        "--jobs",
+        type=int,
+        default=os.cpu_count() or 1,
+        help="number of parallel jobs for scanning modified files",
+    )
+    parser.add_argument(
+        "--no-cache",
+        action="store_true",
+        help=f"don't read or write the declaration index cache ({INDEX_CACHE_FILE})",
+    )
     parser.add_argument("-v", "--verbose", action="store_true", help="verbose output")
     args = parser.parse_args()
 
+    index = DeclarationIndex(None if args.no_cache else INDEX_CACHE_FILE)
+    index.update([FunctionList, DataList], jobs=args.jobs)
     functions_passed = run_symbol_check(
         FunctionList,
         "functions",
         find_extra_symbols=args.extra_symbols,
         check_order=args.sort_order,
         verbose=args.verbose,
+        index=index,
     )
     data_passed = run_symbol_check(
         DataList,
@@ -253,6 +477,8 @@ if __name__ == "__main__":
         find_extra_symbols=args.extra_symbols,
         check_order=args.sort_order,
         verbose=args.verbose,
+        index=index,
     )
+    index.save()
     if not functions_passed or not data_passed:
         raise SystemExit(1)
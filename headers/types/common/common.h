@@ -27,12 +27,37 @@ struct start_module_params {
 ASSERT_SIZE(struct start_module_params, 36);
 
 // Program position info (basically stack trace info) for debug logging.
+// This is usually a pointer to static data filled in by the caller. Note that the memory allocator
+// API functions (MemAlloc, MemFree, etc.) do NOT receive one; the only program position info the
+// allocator uses is its own, for the error it logs when an allocation fails (see MemLocateSet).
 struct prog_pos_info {
     char* file; // file name
     int line;   // line number
 };
 ASSERT_SIZE(struct prog_pos_info, 8);
 
+// The memory allocator (MemAlloc, MemFree, and friends) works on the structures below as follows:
+// - Every memory arena owns one contiguous region of memory (mem_arena::data, mem_arena::len).
+//   The arena's block array (mem_arena::blocks[0..n_blocks]) partitions this region, with blocks
+//   stored in the same order as the memory they describe. A fresh arena has a single vacant block
+//   spanning the whole region.
+// - Allocation picks an arena (explicitly, or by calling the current get_alloc_arena function with
+//   the user flags, falling back to the default arena if it returns null), then calls
+//   FindAvailableMemBlock to pick a block with enough free space, then SplitMemBlock to carve the
+//   requested size off the end of that block. The new block is inserted into the block array right
+//   after the block it was split from, shifting all later entries up one slot. An arena can never
+//   hold more than mem_arena::max_blocks blocks, and running out of space or blocks is fatal.
+// - Freeing (MemLocateUnset) finds the block whose data pointer matches, empties it, and merges it
+//   with adjacent vacant blocks, shifting later entries down to close the gap in the block array.
+// - Lengths are rounded up to a multiple of 4 bytes, so block data pointers stay 4-byte aligned.
+// - The least significant byte of the user flags is never used as an index into
+//   mem_alloc_table::arenas. It only means something to the get_alloc_arena function in use
+//   (see GetAllocArenaDefault and GetAllocArenaGround). mem_alloc_table::arenas is just a
+//   registry of every arena initialized with InitMemArena.
+// Since other code can read the block arrays directly, a replacement allocator installed
+// through SetMemAllocatorParams only affects which arena is chosen. It cannot change how blocks
+// are laid out within an arena.
+
 // Metadata describing a single memory block. A block is a chunk of dynamically allocated memory.
 // It can contain nothing, an allocated object, or a memory arena that itself contains blocks.
 struct mem_block {
@@ -93,6 +118,10 @@ struct mem_arena {
     uint32_t max_blocks;      // 0x10: Maximum number of memory blocks the arena can hold
     void* data;               // 0x14: Pointer to the start of the memory arena
     uint32_t len;             // 0x18: Total length of the memory arena. Always a multiple of 4.
+    // The game doesn't keep any usage statistics for arenas. The current usage of an arena is the
+    // sum of mem_block::used over blocks[0..n_blocks], and the current block count is n_blocks.
+    // Peak values have to be tracked externally. Normal allocations and frees go through
+    // MemLocateSet and MemLocateUnset respectively, but subarenas are carved out by MemArenaAlloc.
 };
 ASSERT_SIZE(struct mem_arena, 28);
 
@@ -170,6 +199,23 @@ struct type_matchup_combinator_table {
 };
 ASSERT_SIZE(struct type_matchup_combinator_table, 64);
 
+// Precombined type matchups against both of a defender's types. This table isn't present in the
+// game; it can be generated by tools/type_matchups.py from the tables in overlay 10.
+//
+// An entry is exactly what combining the type_matchup_table entries for each defender type with
+// the type_matchup_combinator_table gives:
+// matchups[attack_type][type1][type2] == TYPE_MATCHUP_COMBINATOR_TABLE.combination
+//     [TYPE_MATCHUP_TABLE.matchups[attack_type][type1]]
+//     [TYPE_MATCHUP_TABLE.matchups[attack_type][type2]]
+// Monsters with a single type have TYPE_NONE as their second type. Note that this only covers the
+// table-driven part of the matchup calculation. Effects that GetTypeMatchup checks separately
+// (like Ghost immunities, see GhostImmunityIsActive) still need to be applied per type before
+// combining.
+struct type_matchup_combined_table {
+    struct type_matchup_8 matchups[18][18][18];
+};
+ASSERT_SIZE(struct type_matchup_combined_table, 5832);
+
 // In the move data, the target and range are encoded together in the first byte of a single
 // two-byte field. The target is the lower half, and the range is the upper half.
 #pragma pack(push, 2)
@@ -861,7 +907,9 @@ ASSERT_SIZE(struct version_exclusive_monster, 4);
 
 // An entry correspond to sprite loaded in memory and ready to be displayed
 struct wan_table_entry {
-    char path[32];                  // 0x0: Needs to be null-terminated. Only used for direct file.
+    // 0x0: Needs to be null-terminated. Only used for direct file. This is the lookup key for
+    // FindWanTableEntry, so paths are limited to 31 characters.
+    char path[32];
     bool file_externally_allocated; // 0x20: True if the iov_base shouldn’t be freed by this struct.
     struct wan_source_type_8 source_type; // 0x21: 1 = direct file, 2 = pack file
     int16_t pack_id;                      // 0x22: for wan in pack file
@@ -883,6 +931,16 @@ ASSERT_SIZE(struct wan_table_entry, 56);
 
 // Global structure used to deduplicate loading of wan sprites. Loaded sprites are
 // reference-counted.
+//
+// Entries are looked up by key with a linear scan over all 96 entries: by path for direct files
+// (FindWanTableEntry, used by LoadWanTableEntry), and by (pack_id, file_index) for pack files
+// (GetLoadedWanTableEntry, used by LoadWanTableEntryFromPack and
+// LoadWanTableEntryFromPackUseProvidedMemory). A free entry seems to be one whose source_type is
+// WAN_SOURCE_NULL, since AllocateWanTableEntry zeroes the entry it returns and the key fields are
+// only filled in by the load functions afterwards. Keys are added when an entry is loaded, removed
+// by DeleteWanTableEntry once the reference counter reaches 0 (or immediately if
+// file_externally_allocated is set), and can be replaced in place by ReplaceWanFromBinFile, so any
+// index kept alongside the table needs to be updated at those points.
 struct wan_table {
     struct wan_table_entry sprites[96]; // 0x0
     void* at_decompress_scratch_space;  // 0x1500
@@ -891,7 +949,9 @@ struct wan_table {
     undefined field4_0x1506;
     undefined field5_0x1507;
     int16_t total_nb_of_entries;  // 0x1508: The total number of entries. Should be equal to 0x60.
-    int16_t next_alloc_start_pos; // 0x150A
+    // 0x150A: Presumably the entry index where AllocateWanTableEntry starts searching for a free
+    // entry
+    int16_t next_alloc_start_pos;
     int16_t field8_0x150c;
     undefined field9_0x150e;
     undefined field10_0x150f;
@@ -3906,4 +3906,12 @@ enum stairs_type {
 ENUM_8_BIT(box_type);
 #pragma pack(pop)
 
+// State of a thread (see struct thread). The values presumably follow the thread states of the
+// NitroSDK, since the rest of the threading code appears to be the SDK's.
+enum thread_state {
+    THREAD_STATE_WAITING = 0,
+    THREAD_STATE_READY = 1,
+    THREAD_STATE_TERMINATED = 2,
+};
+
 #endif
@@ -137,4 +137,75 @@ struct bg_list_entry {
 };
 ASSERT_SIZE(struct bg_list_entry, 110);
 
+/*  Header of a SIR0 file.
+
+    SIR0 is a wrapper format for files containing pointers. Pointers within the file are stored as
+    offsets relative to the start of the file, and the locations of these pointers are listed in
+    the pointer-offset list so that they can be converted into memory addresses after loading (see
+    HandleSir0Translation). Once converted, the magic is changed from "SIR0" to "SirO" so that the
+    conversion isn't applied twice.
+
+    The pointer-offset list is a sequence of variable-length integers. Each integer is stored in
+    big-endian order, 7 bits per byte, with the most significant bit of each byte set if more bytes
+    of the same integer follow. Each decoded integer is the distance from the previous pointer
+    location (starting from the beginning of the file) to the next one. The list is terminated by
+    a 0 byte. The first two entries refer to the data and ptr_offset_list fields of the header
+    itself.
+
+    Since pointer locations are encoded as deltas, the list has to be decoded sequentially, but it
+    only has to be decoded once: the decoded offsets can be converted individually on demand. */
+struct sir0_header {
+    char magic[4];         // 0x0: "SIR0", or "SirO" after the pointers have been converted
+    void* data;            // 0x4: Pointer to the main content of the file
+    void* ptr_offset_list; // 0x8: Pointer to the encoded pointer-offset list
+    undefined4 field_0xc;  // 0xC: Always zero?
+};
+ASSERT_SIZE(struct sir0_header, 16);
+
+/*  Common header of the AT family of container formats (AT4PX, AT3PX, PKDPX, AT4PN, etc.).
+
+    The containers are not aligned within their parent files, so all of the AT header structs are
+    byte-packed. The magic determines how the rest of the container should be interpreted:
+    - "AT4PX", "AT3PX": PX-compressed data, with an at4px_header
+    - "PKDPX": PX-compressed data, with a pkdpx_header
+    - "AT4PN": uncompressed data immediately following this header
+
+    The PX compression scheme is the same across the compressed variants. The payload is a
+    sequence of command bytes, each of which is followed by the data for 8 operations, processed
+    from the most significant bit to the least significant bit of the command byte:
+    - A set bit means the next byte is copied verbatim to the output.
+    - A clear bit means the next byte is split into a high nibble and a low nibble. If the high
+      nibble is equal to control_flags[i] for some i, 2 bytes (4 nibbles) are written to the
+      output, based on the low nibble and the flag index i. For i = 0, all 4 nibbles are equal to
+      the low nibble. For the other flag indexes, one of the 4 nibbles is offset by one from the
+      others, with the position and direction depending on i.
+    - Otherwise, the command is a back-reference. Another byte is read, and (high nibble + 3)
+      bytes are copied from the output, starting at the current output position plus the
+      (negative) offset ((low nibble << 8) | next byte) - 0x1000. Since the offset is at most
+      0x1000 bytes back, the source and destination can overlap.
+    Decompression stops once decompressed_length bytes have been written. */
+#pragma pack(push, 1)
+struct at_header {
+    char magic[5];             // 0x0: Format identifier, not null-terminated
+    uint16_t container_length; // 0x5: Length of the whole container, including the header
+};
+ASSERT_SIZE(struct at_header, 7);
+
+// Header of AT4PX containers. AT3PX containers seem to share the same layout.
+struct at4px_header {
+    struct at_header header;      // 0x0
+    uint8_t control_flags[9];     // 0x7: High nibble values that mark a 4-nibble pattern
+    uint16_t decompressed_length; // 0x10
+};
+ASSERT_SIZE(struct at4px_header, 18);
+
+// Header of PKDPX containers. Same as at4px_header, but with a 32-bit decompressed length.
+struct pkdpx_header {
+    struct at_header header;      // 0x0
+    uint8_t control_flags[9];     // 0x7: High nibble values that mark a 4-nibble pattern
+    uint32_t decompressed_length; // 0x10
+};
+ASSERT_SIZE(struct pkdpx_header, 20);
+#pragma pack(pop)
+
 #endif
@@ -8,6 +8,15 @@
 
 // Contains data relating to animation.
 // Mentioned under the name of "AnimeCtrl" in a debug message.
+//
+// When an animation is set (see SetAnimationForAnimationControlInternal), the animation group and
+// animation are looked up in the WAN file (wan_header -> wan_animation_header ->
+// wan_animation_group), and pointers into the file are cached in the fields starting at
+// first_animation_frame. Advancing the animation (see SwitchAnimationControlToNextFrame) then only
+// steps through the wan_animation_frame array starting at first_animation_frame, copying the
+// current frame's values into the anim_frame_* fields. Drawing a frame looks up the meta-frame for
+// anim_frame_frame_id in wan_frames and draws each of its struct wan_fragment as an OAM object,
+// with image data from wan_fragments_byte_store and colors from wan_palettes.
 struct animation_control {
     uint16_t some_bitfield;
     undefined2 field1_0x2;
@@ -292,8 +301,28 @@ typedef void (*render_3d_element_64_fn_t)(struct render_3d_element_64* element64
 
 // A global, unique structure that stores element relating to the 3d engine, in particular the list
 // of elements to render later in the frame.
+//
+// Elements are appended to render_queue in submission order (NewRender3dElement,
+// EnqueueRender3dTexture, EnqueueRender3dTiling, and the NewRender3d* wrappers). When the queue is
+// full, NewRender3dElement returns NULL and the element is dropped. Render3dProcessQueue sorts the
+// queued elements, presumably by render_3d_element_hdr::z_index, then dispatches each one through
+// RENDER_3D_FUNCTIONS based on its type.
+//
+// The texture and tiling render functions set up the texture parameters and palette base for
+// every element they draw, even if they match the previous element's (the values last sent are
+// cached in palette_base_addr and texture_vram_offset below). Render3dTextureNoSetup skips this
+// setup, so consecutive elements that share a texture and palette could be drawn with it, as long
+// as reordering them doesn't change the drawing order of overlapping elements.
+//
+// Each element type appears to be drawn as a single quadrilateral polygon (4 vertices), so one
+// flush of the queue sends at most max_index polygons (512 vertices with the usual capacity of 128)
+// to the geometry engine. For reference, the hardware limits per frame are 2048 polygons and 6144
+// vertices (https://problemkaputt.de/gbatek.htm#ds3dpolygondefinitionsbyvertices). Useful places
+// to hook for per-frame counts are NewRender3dElement (every queue insertion, including dropped
+// ones when it returns NULL), Render3dElement64 (every render_3d_element_64, by render_type_64),
+// and Render3dProcessQueue, where current_index is the number of elements about to be drawn.
 struct render_3d_global {
-    int16_t current_index; // 0x0
+    int16_t current_index; // 0x0: Index of the next free slot in render_queue
     int16_t max_index;     // 0x2: Seems to consistently be 128, size of render_queue
     // 0x4: palette_base_addr of the most recent render_3d_texture/render_3d_tiling
     int32_t palette_base_addr;
@@ -382,7 +411,9 @@ struct palette_data {
     struct rgba flush_colors;
     uint32_t field6_0x10;
     refresh_command_fn_t refresh_command;
-    struct rgba* rgba_palette;
+    struct rgba* rgba_palette; // Source colors, with 8 bits per channel
+    // Presumably the transformed colors in the format of struct rgb5, ready to be copied to the
+    // palette RAM
     uint16_t* raw_palette;
     struct palette_data* previous_palette;
     struct palette_data* next_palette;
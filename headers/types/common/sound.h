@@ -231,13 +231,18 @@ struct dse_channel {
 };
 ASSERT_SIZE(struct dse_channel, 200);
 
+// Header of a chunk in a DSE file. In SWD files, the chunks follow struct dse_swd_file_header,
+// usually in the order "wavi" (sample info), "prgi" (instruments), "kgrp" (keygroups),
+// "pcmd" (PCM data) and "eod " (end of data), where the chunks a file doesn't need are omitted.
+// For example, wave banks that use a main bank (dse_swd_file_header::mainbank_id) have no pcmd
+// chunk, and main banks only have wavi and pcmd chunks.
 struct dse_file_chunk {
-    uint32_t signature;
+    uint32_t signature; // 4-character chunk name, like "wavi"
     uint32_t field_0x4;
     uint8_t padding_alignment;
     uint8_t field_0x9;
     uint16_t field_0xA;
-    uint32_t data_size;
+    uint32_t data_size; // Size of the data following the header, in bytes
 };
 ASSERT_SIZE(struct dse_file_chunk, 16);
 
@@ -252,6 +257,9 @@ struct dse_file_header {
 };
 ASSERT_SIZE(struct dse_file_header, 48);
 
+// Custom allocator for the DSE sound heap, passed through dse_driver_settings. If the callbacks are
+// set, DseMem_* allocations are presumably forwarded to them (along with arg) instead of being
+// carved out of the fixed heap region.
 struct dse_heap_allocator {
     void* allocate_fun;
     void* free_fun;
@@ -298,23 +306,29 @@ struct dse_instrument {
 };
 ASSERT_SIZE(struct dse_instrument, 48);
 
+// A keygroup limits which voices the notes of an instrument split can be played on (see
+// dse_instrument_split::keygroup_index and DseVoice_Allocate).
 struct dse_keygroup {
     uint8_t index;
     uint8_t field_0x1;
-    uint8_t max_polyphony;
-    uint8_t priority;
-    uint8_t min_voice_index;
-    uint8_t max_voice_index;
+    uint8_t max_polyphony;   // Maximum number of voices the keygroup can use at the same time
+    uint8_t priority;        // Priority of the keygroup's notes when allocating voices
+    uint8_t min_voice_index; // Lowest index into dse_driver_work::voices the keygroup can use
+    uint8_t max_voice_index; // Highest index into dse_driver_work::voices the keygroup can use
     uint8_t field_0x6;
     uint8_t field_0x7;
 };
 ASSERT_SIZE(struct dse_keygroup, 8);
 
+// A main bank SWD file, which holds sample data shared by wave banks. Main banks are opened by
+// DseSwd_LoadMainBank and stay open in the dse_driver_work::loaded_mainbanks list, so that
+// samples can be streamed from the file on demand (see DseSwd_LoadWaves) rather than being kept in
+// the sound heap.
 struct dse_mainbank {
     uint16_t id;
     uint16_t num_wavi;
-    uint32_t pcm_data_offset;
-    void* wavi_data;
+    uint32_t pcm_data_offset; // File offset of the pcmd chunk's data
+    void* wavi_data;          // The wavi chunk's data, kept in memory while the bank is loaded
     uint32_t field_0xC;
     uint32_t field_0x10;
 
@@ -353,6 +367,8 @@ struct dse_sample {
     uint8_t field_0x4[5];
     uint8_t psg_duty;
     uint8_t field_0xA[10];
+    // In a SWD file, this is presumably the offset of the sample from the start of the pcmd
+    // chunk's data. It's a pointer once the sample data is loaded.
     void* sample_pcm_data;
     int sample_loop_start;
     int sample_size;
@@ -401,7 +417,7 @@ struct dse_swd_file_header {
     uint16_t num_instruments; // a.k.a. programs or presets
     uint8_t num_keygroups;
     uint8_t sample_container_kind;
-    uint32_t wavi_data_size;
+    uint32_t wavi_data_size; // Size of the wavi chunk's data, in bytes
 };
 ASSERT_SIZE(struct dse_swd_file_header, 80);
 
@@ -535,8 +551,9 @@ struct dse_voice {
     uint32_t field_0x148;
     uint8_t envelope_volume;
     uint8_t field_0x14D[7];
+    // Next voice allocated to the same channel. The list starts at dse_channel::voice_list.
     struct dse_voice* next_in_channel_allocation_list;
-    struct dse_channel* channel_allocation;
+    struct dse_channel* channel_allocation; // Channel the voice is allocated to, if any
 };
 ASSERT_SIZE(struct dse_voice, 348);
 
@@ -546,6 +563,10 @@ struct dse_wave {
 };
 ASSERT_SIZE(struct dse_wave, 48);
 
+// A wave bank SWD file loaded by DseSwd_LoadBank. Loaded wave banks are kept in the
+// dse_driver_work::loaded_wavebanks_list list until they're unloaded with DseSwd_Unload. The PCM
+// data of a bank that refers to a main bank (mainbank_id) is loaded separately from the main bank
+// with DseSwd_LoadWaves, into a buffer provided by the caller.
 struct dse_wavebank {
     void* file;
     uint16_t id;
@@ -627,12 +648,19 @@ struct dse_driver_work {
     struct dse_sequence* se_sequences_list;
     struct dse_se_bank* loaded_effect_banks;
     uint8_t field_0x670[132];
+    // State of the DSE sound heap (see DseMem_Init). All allocations share a single list of nodes
+    // in the heap region, regardless of size or label, so loading and unloading banks of different
+    // sizes can fragment the heap over time. The layout of struct dse_heap_node is unknown.
     struct dse_heap_node* heap_node_list;
     void* heap_end;
     int heap_size;
     struct dse_heap_allocator heap_allocator;
     uint8_t field_0x70C[36];
     int16_t num_voices;
+    // Voice state bitmasks, with one bit per element of voices (see dse_voice::hw_voice_bit).
+    // Since there are only 16 voices, a free voice can be found by scanning one of these masks
+    // rather than the voices themselves. The start, deactivate and deallocate masks hold changes
+    // that are pending until the next DseVoice_UpdateHardware.
     uint16_t active_voices_bits;
     uint16_t start_voices_bits;
     uint16_t deactivate_voices_bits;
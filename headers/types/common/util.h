@@ -20,7 +20,9 @@ struct rgba {
 };
 ASSERT_SIZE(struct rgba, 4);
 
-// RGB5 color
+// RGB5 color, in the format used by the DS palette RAM. Since each color is 2 bytes, a 32-bit
+// word holds two adjacent palette entries.
+// See https://problemkaputt.de/gbatek.htm#lcdcolorpalettes
 struct rgb5 {
     uint16_t r : 5;
     uint16_t g : 5;
@@ -124,9 +126,13 @@ typedef void (*thread_entry_fn_t)(void);
 typedef void (*thread_exit_fn_t)(void);
 
 // Contains information about a running thread
+// The first 0x64 bytes hold the thread's saved CPU context. These are restored when the thread
+// is switched to.
 struct thread {
-    int flags;                // Probably a flags field. Usually 0x1F.
-    struct thread* field_0x4; // r2 parameter in ThreadStart
+    // 0x0: Saved program status register (cpsr). Usually 0x1F (System mode), or 0x3F
+    // (System mode with the Thumb bit set) if the thread's function is Thumb code.
+    int flags;
+    struct thread* field_0x4; // r2 parameter in ThreadStart. Saved r0.
     undefined4 field_0x8;     // Initialized to 0
     undefined4 field_0xC;     // Initialized to 0
     undefined4 field_0x10;    // Initialized to 0
@@ -175,31 +181,39 @@ struct thread {
     undefined field_0x61;
     undefined field_0x62;
     undefined field_0x63;
-    undefined4 field_0x64; // Initialized to 0
+    enum thread_state state; // 0x64
     // 0x68: Pointer to the next thread. This forms a linked list sorted in ascending order
     // according to sorting_order
     struct thread* next_thread;
     // 0x6C: Seems to be a thread ID that gets incremented for each new thread created.
     int thread_id;
-    int sorting_order;       // 0x70: Unknown. Used to sort threads.
-    undefined4 field_0x74;   // Initialized to 0
-    undefined4 field_0x78;   // Initialized to 0
-    undefined4 field_0x7C;   // Initialized to 0
-    undefined4 field_0x80;   // Initialized to 0
+    // 0x70: Priority of the thread. Lower values seem to mean higher priority, which is why the
+    // thread list is sorted in ascending order.
+    int sorting_order;
+    undefined4 field_0x74; // Initialized to 0
+    // 0x78: Initialized to 0. Presumably the queue the thread is waiting on while it's not ready.
+    void* wait_queue;
+    // 0x7C: Initialized to 0. Presumably the previous and next threads waiting on the same queue.
+    struct thread* wait_queue_prev;
+    struct thread* wait_queue_next;
     undefined4 field_0x84;   // Initialized to 0
     undefined4 field_0x88;   // Initialized to 0
     undefined4 field_0x8C;   // Initialized to 0
     void* stack_end_pointer; // 0x90: Pointer to the end of the stack area (exclusive)
     void* stack_pointer;     // 0x94: Pointer to the start of the stack area (inclusive)
     undefined4 field_0x98;   // Initialized to 0
-    undefined4 field_0x9C;   // Initialized to 0
-    undefined4 field_0xA0;   // Initialized to 0
+    // 0x9C: Initialized to 0. Presumably the first and last threads waiting for this thread to
+    // exit.
+    struct thread* join_queue_head;
+    struct thread* join_queue_tail;
     // Initialized to 0. Actually part of a separate struct alongside field_0xA8 and field_0xAC.
     undefined4 field_0xA4;
     undefined4 field_0xA8; // Initialized to 0
     undefined4 field_0xAC; // Initialized to 0
     undefined4 field_0xB0; // Initialized to 0
-    undefined4 field_0xB4; // Initialized to 0
+    // 0xB4: Initialized to 0. Presumably a function called when the thread is destroyed.
+    // See SetThreadField0xB4.
+    undefined4 field_0xB4;
     undefined field_0xB8;
     undefined field_0xB9;
     undefined field_0xBA;
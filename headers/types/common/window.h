@@ -9,6 +9,7 @@
 
 // These flags are shared with the function to display text inside windows
 // So they might need a rename once more information is found
+// Passed to PreprocessString along with struct preprocessor_args
 struct preprocessor_flags {
     bool timer_1 : 1; // Enabled when creating the play time string
     uint16_t flags_1 : 9;
@@ -285,6 +286,11 @@ struct window_trailer {
 ASSERT_SIZE(struct window_trailer, 36);
 
 // Generic structure for a window containing content
+// Active windows are presumably updated once per frame through params.update, which is specific
+// to the window type (e.g., UpdateTextBox, UpdatePortraitBox, UpdateSimpleMenu). An update
+// function redraws the window contents as needed and calls UpdateWindow to commit them for
+// display. There's no known window-level dirty state; each window type decides on its own whether
+// to redraw (e.g., see portrait_box::state).
 struct window {
     struct window_params params; // 0x0
     // 0x10: it seems like some windows, such as the scroll box, can have an associated sub-window
@@ -293,6 +299,8 @@ struct window {
     uint8_t field_0x11;
     uint16_t field_0x12;
     // Some heap-allocated struct pointer with size (hdr.width * hdr.height * 0x40)
+    // This is 0x40 bytes for each 8x8 tile in the window, so it might be the buffer that the window
+    // contents are drawn into before being committed with UpdateWindow
     undefined* field_0x14;
     int field_0x18;
     int field_0x1c; // hdr.width * hdr.height * 0x40
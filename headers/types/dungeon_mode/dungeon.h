@@ -1341,7 +1341,7 @@ struct dungeon {
     undefined field_0xd2e2;
     undefined field_0xd2e3;
     // 0xD2E4: This is an array of pointers that point to the actual tile structs within the
-    // dungeon struct
+    // dungeon struct. Indexed as [y][x]. See GetTile and GetTileSafe for bounds-checked access.
     struct tile* tile_ptrs[32][56];
     uint8_t n_rooms;        // 0xEEE4: Number of rooms on the current floor
     undefined field_0xeee5; // Uninitialized, likely padding
@@ -1564,6 +1564,9 @@ struct dungeon {
     // item spawn list.
     // It has enough space to hold 1416 entries (1400 items + 16 categories), but only the
     // first 0x16C slots are used since spawn lists can't encode item IDs larger than that.
+    // Like the weights in struct monster_spawn_entry, these seem to be cumulative: the weight of
+    // an individual entry is the difference from the previous weight of the same kind (category
+    // or item).
     uint16_t regular_item_weights[1416];
     // 0x29202: Spawn weights for Kecleon shop items. Same format as regular_item_weights.
     uint16_t kecleon_item_weights[1416];
@@ -747,10 +747,16 @@ struct entity {
 ASSERT_SIZE(struct entity, 184);
 
 // Dungeon entity table header
+//
+// The slot counts (20 monsters, 64 items, 64 traps and 1 hidden stairs) add up to the 149
+// entries of entity_table::entities, so each slot presumably owns one fixed entry in that array.
+// This also bounds any scan over monsters to at most 20 entries.
 struct entity_table_hdr {
-    // 0x0: A list of all monster pointers, whether they're used or not
+    // 0x0: A list of all monster pointers, whether they're used or not. The first 4 slots are
+    // used for team members (see GetLeader and GetTeamMemberIndex).
     struct entity* monster_slot_ptrs[20];
-    // 0x50: Null-terminated array of pointers to actually active monsters
+    // 0x50: Null-terminated array of pointers to actually active monsters. This is rebuilt from
+    // monster_slot_ptrs by PopulateActiveMonsterPtrs.
     struct entity* active_monster_ptrs[20];
     struct entity* item_ptrs[64];     // 0xA0
     struct entity* trap_ptrs[64];     // 0x1A0
@@ -794,6 +800,10 @@ union spawn_or_visibility_flags {
 ASSERT_SIZE(union spawn_or_visibility_flags, 2);
 
 // Tile data
+// The floor is a grid of 56x32 tiles (see struct dungeon::tile_ptrs, which is indexed as
+// [y][x]). Tiles on the outer edge of the grid are always impassable walls. Since a row is 56 tiles
+// wide, a single tile property (e.g., terrain_type == TERRAIN_NORMAL, or one bit of
+// walkable_neighbor_flags) can be packed into one 64-bit word per row, with x as the bit index.
 struct tile {
     // 0x0: terrain_flags: 2-byte bitfield
     enum terrain_type terrain_type : 2;
@@ -835,6 +845,9 @@ struct tile {
     // Each element is a bitflag that corresponds to one of the first four values of
     // enum mobility_type. Each bit in the bitflag corresponds to the values of enum direction,
     // where 1 means a monster with that mobility type is allowed to walk in that direction.
+    // So bit (1 << DIR_DOWN) of walkable_neighbor_flags[MOBILITY_NORMAL] covers moving from
+    // (x, y) to (x, y + 1). These flags are a cache, refreshed by DetermineTileWalkableNeighbors;
+    // they only depend on the terrain of the tile and its 8 neighbors, not on monsters or objects.
     uint8_t walkable_neighbor_flags[4];
     struct entity* monster; // 0xC: Pointer to a monster on this tile, if any
     // 0x10: Pointer to an entity other than a monster on this tile (item/trap)
@@ -842,7 +855,9 @@ struct tile {
 };
 ASSERT_SIZE(struct tile, 20);
 
-// Information about the rooms on the current floor
+// Information about the rooms on the current floor. Stored in dungeon::room_data, indexed by
+// tile::room. The corners bound the room's floor tiles, and are what IsPositionActuallyInSight
+// uses to check if a position is in the same room.
 struct room_data {
     uint8_t room_id;
     undefined field_0x1;                 // Initialized to 0
@@ -962,9 +977,11 @@ ASSERT_SIZE(struct minimap_display_tile, 64);
 
 // Contains the graphical representation of minimap tiles
 struct minimap_display_data {
-    // 0x0: Matrix that contains tile display data. Each chunk of 4x4 tiles shares
-    // a single entry in this matrix. (To calculate which entry corresponds to a
-    // given (x,y) coordinate, simply divide both x and y by 2 and drop decimals)
+    // 0x0: Matrix that contains tile display data. Since the floor is 56x32 tiles, each chunk of
+    // 2x2 floor tiles shares a single entry in this matrix. (To calculate which entry corresponds
+    // to a given (x,y) coordinate, simply divide both x and y by 2 and drop decimals)
+    // DrawMinimapTile(x, y) redraws the entry containing (x, y), so this 28x16 grid is also the
+    // natural granularity for tracking which parts of the minimap need to be redrawn.
     struct minimap_display_tile tile_matrix_1[16][28];
     // 0x7000: Another matrix just like the first one
     struct minimap_display_tile tile_matrix_2[16][28];
@@ -982,8 +999,8 @@ struct minimap_display_data {
     undefined field_0xE444;
     undefined field_0xE445;
     undefined field_0xE446;
-    undefined field_0xE447;
-    undefined field_0xE448;
+    uint8_t field_0xE447; // Accessed through SetMinimapDataE447 and GetMinimapDataE447
+    uint8_t field_0xE448; // Accessed through SetMinimapDataE448
     // Padding?
     undefined field_0xE449;
     undefined field_0xE44A;
@@ -1277,6 +1294,13 @@ struct effect_animation {
 ASSERT_SIZE(struct effect_animation, 28);
 
 // Contains data about a monster that spawns in a dungeon
+// The spawn weights are cumulative over a spawn list: the weight of an individual entry is its
+// incremental weight minus the incremental weight of the previous entry (or 0 for the first
+// entry), so the last entry of the list holds the total weight. Entries with the same incremental
+// weight as the previous entry presumably can't be picked. Since the individual weights are all
+// that matter for the resulting distribution, a spawn list can be converted into any other
+// weighted sampling structure (like an alias table) without changing the spawn chances, although
+// the random numbers drawn will be different from the ones the game draws.
 struct monster_spawn_entry {
     uint16_t level_mult_512; // 0x0: Spawn level << 9
     // 0x2: Incremental spawn weight of this entry for normal spawns
@@ -1568,7 +1592,10 @@ struct map_marker {
 ASSERT_SIZE(struct map_marker, 8);
 
 // The LCG states for the dungeon PRNG. See the relevant functions in the overlay 29 symbols for an
-// explanation of how the dungeon PRNG works.
+// explanation of how the dungeon PRNG works (DungeonRand16Bit also describes how to skip ahead in
+// a sequence without stepping through it).
+// The current values of the 5 secondary LCGs are not part of this struct. They're stored in a
+// separate uint32_t[5] array (DUNGEON_PRNG_STATE_SECONDARY_VALUES), indexed by idx_secondary.
 struct prng_state {
     int use_secondary;        // 0x0: Flag for whether or not to use the secondary LCGs
     uint32_t seq_num_primary; // 0x4: Sequence number for the primary LCG sequence
@@ -1577,7 +1604,9 @@ struct prng_state {
     uint32_t preseed;
     // 0xC: The last value generated by the PRNG, corresponding to seq_num_primary
     uint32_t last_value_primary;
-    int idx_secondary; // 0x10: Index of the currently active secondary LCG
+    // 0x10: Index of the currently active secondary LCG, in the range [0, 4].
+    // Only used if use_secondary is set.
+    int idx_secondary;
 };
 ASSERT_SIZE(struct prng_state, 20);
 
@@ -1628,6 +1657,8 @@ struct spawned_shopkeeper_data {
 ASSERT_SIZE(struct spawned_shopkeeper_data, 6);
 
 // Appears to contain diagnostic information related to the damage calculation routines.
+// The most recent one is stored in dungeon::last_damage_calc. See CalcDamage for the stages of the
+// calculation that each of the fields corresponds to.
 struct damage_calc_diag {
     struct type_id_8 move_type; // 0x0: The type of the last move used
     undefined field_0x1;
@@ -1440,10 +1440,12 @@ ENUM_8_BIT(fixed_room_action_non_entity);
 #pragma pack(pop)
 
 // Used to determine an action that will be performed when spawining a single tile during fixed
-// room generation. Can spawn an entity or a tile.
+// room generation. Can spawn an entity or a tile. The actions for each tile of a fixed room are
+// read one at a time with GetNextFixedRoomAction and then performed with PlaceFixedRoomTile.
 union fixed_room_action {
     struct fixed_room_action_non_entity_8 tile_action;
-    // If specified, this value - 16 represents the ID of the fixed entity to spawn.
+    // If specified, this value - 16 represents the ID of the fixed entity to spawn, which is an
+    // index into FIXED_ROOM_ENTITY_SPAWN_TABLE.
     uint8_t entity_action;
 };
 
@@ -16,6 +16,8 @@ ENUM_16_BIT(wan_sprite_type);
 #pragma pack(pop)
 
 struct wan_animation_header {
+    // Meta-frames, indexed by wan_animation_frame::frame_id. Each entry points to a list of
+    // struct wan_fragment, the last of which is marked in wan_fragment::attr1.
     void* frames;
     struct wan_offset* frame_offsets;
     struct wan_animation_group* animations;
@@ -65,6 +67,25 @@ struct wan_animation_frame {
 };
 ASSERT_SIZE(struct wan_animation_frame, 12);
 
+// A piece of a meta-frame, drawn as a single OAM object. The attributes are laid out like the
+// corresponding NDS OAM attributes, with a few bits repurposed. Names come from the pmd_wan
+// project.
+struct wan_fragment {
+    // Index into wan_image_header::fragments_bytes_store, or -1 to reuse the image data of the
+    // previous fragment
+    int16_t fragment_bytes_index;
+    uint16_t unk1;
+    // Y offset in the low 8 bits, OAM shape in the top 2 bits. Bit 12 (0x1000) is the mosaic flag.
+    uint16_t attr0;
+    // X offset in the low 9 bits, OAM size in the top 2 bits. Bit 11 (0x800) marks the last
+    // fragment of the meta-frame, bits 12 and 13 (0x1000, 0x2000) are the horizontal and vertical
+    // flip flags.
+    uint16_t attr1;
+    // Palette index in the top 4 bits
+    uint16_t attr2;
+};
+ASSERT_SIZE(struct wan_fragment, 10);
+
 struct wan_image_header {
     void** fragments_bytes_store;
     struct wan_palettes* palettes;
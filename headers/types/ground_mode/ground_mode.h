@@ -11,7 +11,10 @@ struct script_var {
     undefined2 field_0x1;           // 0x2
     // 0x4: value's offset into struct script_var_value_table, if type != VARTYPE_SPECIAL
     uint16_t mem_offset;
-    uint16_t bitshift; // 0x6: bit position if type == VARTYPE_BIT
+    // 0x6: bit position if type == VARTYPE_BIT. Values of bit arrays appear to be packed
+    // contiguously, so value i is bit ((bitshift + i) % 8) of the byte at
+    // (mem_offset + (bitshift + i) / 8). For other types, values are stored back to back.
+    uint16_t bitshift;
     uint16_t n_values; // 0x8: number of values (>1 means this variable is an array)
     // 0xA: 0 for every variable except VAR_VERSION, which has a default value of 1.
     int16_t default_val;
@@ -205,11 +208,26 @@ struct script_opcode {
 ASSERT_SIZE(struct script_opcode, 8);
 
 // Table of all opcodes for the script engine.
+//
+// The table only holds metadata about each opcode: there are no per-opcode handler functions.
+// Instead, RunNextOpcode executes opcodes with one large switch statement over the opcode ID.
+// Opcode parameters are 16-bit values that are decoded by the handler that uses them, through
+// ScriptParamToInt or ScriptParamToFixedPoint16. Both conversions only depend on the raw
+// parameter, so they can be precomputed ahead of time.
 struct script_opcode_table {
     struct script_opcode ops[383];
 };
 ASSERT_SIZE(struct script_opcode_table, 3064);
 
+// State of a script being run by the script engine, passed to RunNextOpcode. The layout is mostly
+// unknown, but the ID of the opcode to run next can be found at offset 0x1C.
+//
+// For profiling, RunNextOpcode is entered once per executed opcode, and FuncThatCallsRunNextOpcode
+// presumably once per stepped script, so timing these calls attributes frame time to opcodes and
+// to script states. Calls into common routines can be identified through GetCoroutineInfo, which
+// receives the enum common_routine_id being called.
+struct script_engine_state;
+
 // Common routines used within the unionall.ssb script (the master script).
 struct common_routine {
     struct common_routine_id_16 id;
@@ -233,10 +251,13 @@ struct script_coroutine {
 };
 ASSERT_SIZE(struct script_coroutine, 6);
 
-// Contains additional info about a scripting coroutine loaded in RAM.
+// Contains additional info about a scripting coroutine loaded in RAM. Filled in by
+// GetCoroutineInfo when a script calls a common routine (CallCommon).
 struct coroutine_info {
-    void* unionall_start;  // 0x0: RAM address where unionall starts
-    void* coroutine_start; // 0x4: RAM address where the coroutine starts
+    void* unionall_start; // 0x0: RAM address where unionall starts
+    // 0x4: RAM address where the coroutine starts. Presumably unionall_start plus twice the
+    // script_coroutine::offset of the coroutine, since offsets are in halfwords.
+    void* coroutine_start;
     undefined4 field_0x8;
     undefined field_0xc;
     undefined field_0xd;
@@ -288,6 +309,9 @@ ASSERT_SIZE(struct animation_data, 2);
 #pragma pack(pop)
 
 // represent an actor present in the scene in the overworld (both during cutscenes and free-roams)
+// Of the known fields, is_enabled tells whether a slot is in use at all, and movement_related
+// seems to tell whether the actor is moving. No field is known to track whether an actor is
+// visible on screen; that has to be derived from coord_min/coord_max.
 struct live_actor {
     struct monster_id_16
         species_id;     // The id of the Actor in the actor list. Internally named type.
@@ -377,6 +401,7 @@ struct live_actor {
 ASSERT_SIZE(struct live_actor, 592);
 
 // A list of 24 actors, which is the number of statically allocated live actor
+// Unused slots have live_actor::is_enabled set to false.
 struct live_actor_list {
     struct live_actor actors[24];
 };
@@ -388,9 +413,11 @@ struct main_ground_data {
     undefined*
         partner_follow_data; // 0x4: pointer to the data related to the partner following the player
     struct live_actor_list* actors; // 0x8: pointer to the actors
-    undefined* objects;             // 0xC: pointer to the objects
-    undefined* performers;          // 0x10: pointer to the performers
-    undefined* events;              // 0x14: pointer to the events
+    // The layouts of the following lists aren't known yet. They're presumably statically
+    // allocated lists like live_actor_list.
+    undefined* objects;    // 0xC: pointer to the objects
+    undefined* performers; // 0x10: pointer to the performers
+    undefined* events;     // 0x14: pointer to the events
 };
 ASSERT_SIZE(struct main_ground_data, 24);
 
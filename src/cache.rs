@@ -0,0 +1,205 @@
+//! On-disk caching of per-file results, so that commands like `check` and `fmt --check` can skip
+//! input files that haven't changed since the last run.
+//!
+//! Cache entries are keyed by a hash of everything that can affect a result: the `resymgen`
+//! version, the command configuration, and the contents of the input file along with (in
+//! recursive mode) every file in its subregion directory. This means that a result spanning
+//! multiple files is only invalidated when one of its member files changes.
+
+use std::collections::HashMap;
+use std::error::Error;
+use std::fs::{self, File};
+use std::io::{self, BufReader};
+use std::path::{Path, PathBuf};
+
+use serde::de::DeserializeOwned;
+use serde::{Deserialize, Serialize};
+use tempfile::NamedTempFile;
+
+use super::data_formats::symgen_yml::Subregion;
+use super::util;
+
+/// 64-bit FNV-1a hasher. Unlike [`std::collections::hash_map::DefaultHasher`], the output is
+/// guaranteed to be stable across Rust releases, which matters since hashes are persisted.
+struct Fnv1a(u64);
+
+impl Fnv1a {
+    fn new() -> Self {
+        Self(0xcbf29ce484222325)
+    }
+    fn write(&mut self, bytes: &[u8]) {
+        for &b in bytes {
+            self.0 ^= b as u64;
+            self.0 = self.0.wrapping_mul(0x100000001b3);
+        }
+    }
+    /// Writes a length-prefixed byte string, so that consecutive fields can't run together.
+    fn write_field(&mut self, bytes: &[u8]) {
+        self.write(&(bytes.len() as u64).to_le_bytes());
+        self.write(bytes);
+    }
+}
+
+/// Appends all files under `dir` to `files`, in sorted order. A missing directory is treated as
+/// empty.
+fn collect_files_recursive(dir: &Path, files: &mut Vec<PathBuf>) -> io::Result<()> {
+    let entries = match fs::read_dir(dir) {
+        Ok(entries) => entries,
+        Err(e) if e.kind() == io::ErrorKind::NotFound => return Ok(()),
+        Err(e) => return Err(e),
+    };
+    let mut paths = entries
+        .map(|entry| entry.map(|e| e.path()))
+        .collect::<io::Result<Vec<_>>>()?;
+    paths.sort();
+    for path in paths {
+        if path.is_dir() {
+            collect_files_recursive(&path, files)?;
+        } else {
+            files.push(path);
+        }
+    }
+    Ok(())
+}
+
+/// Computes the cache key for the result of processing `input_file` with the given `config`.
+///
+/// In `recursive` mode, the key covers all files in the subregion directory of `input_file`,
+/// not just the subregion files that are actually referenced. This might invalidate an entry
+/// unnecessarily, but never fails to invalidate one.
+pub fn content_key<P: AsRef<Path>>(
+    input_file: P,
+    recursive: bool,
+    config: &str,
+) -> io::Result<String> {
+    let input_file = input_file.as_ref();
+    let mut hasher = Fnv1a::new();
+    hasher.write_field(env!("CARGO_PKG_VERSION").as_bytes());
+    hasher.write_field(config.as_bytes());
+    hasher.write_field(&[recursive as u8]);
+    hasher.write_field(&fs::read(input_file)?);
+    if recursive {
+        let subregion_dir = Subregion::subregion_dir(input_file);
+        let mut files = Vec::new();
+        collect_files_recursive(&subregion_dir, &mut files)?;
+        for file in files {
+            let relative_path = file.strip_prefix(&subregion_dir).unwrap_or(&file);
+            hasher.write_field(relative_path.to_string_lossy().as_bytes());
+            hasher.write_field(&fs::read(&file)?);
+        }
+    }
+    Ok(format!("{:016x}", hasher.0))
+}
+
+#[derive(Debug, Serialize, Deserialize)]
+struct CacheEntry<T> {
+    key: String,
+    value: T,
+}
+
+/// A persistent map from input file names to results, each valid for a specific cache key
+/// (see [`content_key`]).
+#[derive(Debug)]
+pub struct ResultCache<T> {
+    path: PathBuf,
+    entries: HashMap<String, CacheEntry<T>>,
+    modified: bool,
+}
+
+impl<T: Serialize + DeserializeOwned> ResultCache<T> {
+    /// Loads the cache stored at `path`. If the file doesn't exist or can't be read as a cache,
+    /// the cache starts out empty.
+    pub fn load<P: AsRef<Path>>(path: P) -> Self {
+        let path = path.as_ref().to_owned();
+        let entries = File::open(&path)
+            .ok()
+            .and_then(|f| serde_json::from_reader(BufReader::new(f)).ok())
+            .unwrap_or_default();
+        Self {
+            path,
+            entries,
+            modified: false,
+        }
+    }
+
+    /// Returns the cached result for `input_file`, if there is one for the given `key`.
+    pub fn get<P: AsRef<Path>>(&self, input_file: P, key: &str) -> Option<&T> {
+        self.entries
+            .get(input_file.as_ref().to_string_lossy().as_ref())
+            .filter(|entry| entry.key == key)
+            .map(|entry| &entry.value)
+    }
+
+    /// Stores the result for `input_file`, replacing any previous result.
+    pub fn insert<P: AsRef<Path>>(&mut self, input_file: P, key: String, value: T) {
+        self.entries.insert(
+            input_file.as_ref().to_string_lossy().into_owned(),
+            CacheEntry { key, value },
+        );
+        self.modified = true;
+    }
+
+    /// Writes the cache back to disk if it was modified, creating parent directories as needed.
+    pub fn save(&mut self) -> Result<(), Box<dyn Error>> {
+        if !self.modified {
+            return Ok(());
+        }
+        if let Some(parent) = self.path.parent() {
+            fs::create_dir_all(parent)?;
+        }
+        // Write to a tempfile first, then replace the old one atomically.
+        let output_file = NamedTempFile::new()?;
+        serde_json::to_writer(&output_file, &self.entries)?;
+        util::persist_named_temp_file_safe(output_file, &self.path)?;
+        self.modified = false;
+        Ok(())
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_content_key() {
+        let dir = tempfile::tempdir().expect("Failed to create temp dir");
+        let top = dir.path().join("top.yml");
+        let sub = dir.path().join("top").join("sub.yml");
+        fs::create_dir(dir.path().join("top")).unwrap();
+        fs::write(&top, "top").unwrap();
+        fs::write(&sub, "sub").unwrap();
+
+        let key = content_key(&top, true, "cfg").unwrap();
+        assert_eq!(key, content_key(&top, true, "cfg").unwrap());
+        assert_ne!(key, content_key(&top, true, "other cfg").unwrap());
+        assert_ne!(key, content_key(&top, false, "cfg").unwrap());
+
+        // Changing a subregion file should only affect recursive keys
+        let nonrecursive_key = content_key(&top, false, "cfg").unwrap();
+        fs::write(&sub, "sub2").unwrap();
+        assert_ne!(key, content_key(&top, true, "cfg").unwrap());
+        assert_eq!(nonrecursive_key, content_key(&top, false, "cfg").unwrap());
+    }
+
+    #[test]
+    fn test_result_cache() {
+        let dir = tempfile::tempdir().expect("Failed to create temp dir");
+        let path = dir.path().join("nested").join("cache.json");
+
+        let mut cache = ResultCache::<bool>::load(&path);
+        assert_eq!(cache.get("a.yml", "k1"), None);
+        cache.insert("a.yml", "k1".to_string(), true);
+        cache.insert("b.yml", "k2".to_string(), false);
+        cache.save().expect("Failed to save cache");
+
+        let cache = ResultCache::<bool>::load(&path);
+        assert_eq!(cache.get("a.yml", "k1"), Some(&true));
+        assert_eq!(cache.get("a.yml", "k2"), None);
+        assert_eq!(cache.get("b.yml", "k2"), Some(&false));
+
+        // Corrupt caches are ignored
+        fs::write(&path, "not json").unwrap();
+        let cache = ResultCache::<bool>::load(&path);
+        assert_eq!(cache.get("a.yml", "k1"), None);
+    }
+}
@@ -11,14 +11,16 @@ use std::iter;
 use std::path::{Path, PathBuf};
 use std::rc::Rc;
 
+use serde::{Deserialize, Serialize};
 use syn::{self, Ident};
 use termcolor::{Color, ColorChoice, ColorSpec, StandardStream, WriteColor};
 
+use super::cache::{self, ResultCache};
 use super::data_formats::symgen_yml::bounds::{self, BoundViolation};
 use super::data_formats::symgen_yml::{
     Block, MaybeVersionDep, OrdString, Subregion, SymGen, Symbol, Uint, Version, VersionDep,
 };
-use super::util::MultiFileError;
+use super::util::{self, MultiFileError};
 
 /// Naming conventions for symbol names.
 #[derive(Debug, Clone, Copy, PartialEq, Eq, PartialOrd, Ord)]
@@ -154,7 +156,7 @@ impl NamingConvention {
 }
 
 /// Checks that can be run on `resymgen` YAML symbol tables.
-#[derive(Debug, Clone)]
+#[derive(Debug, Clone, PartialEq, Eq)]
 pub enum Check {
     /// All addresses and lengths (for both blocks and symbols) must be explicitly listed by version.
     ExplicitVersions,
@@ -686,6 +688,9 @@ fn check_no_overlap(symgen: &SymGen) -> Result<(), String> {
                 }
             }
         }
+        /// Sweeps over the extents in order of start address. Once sorted, a set of extents is free
+        /// of overlaps if and only if each extent ends before the next one starts, so this takes
+        /// O(n log n) time.
         fn check_exts_for_self_overlap(
             exts: &mut [(Extent, &str)],
             ext_type: &str,
@@ -725,6 +730,10 @@ fn check_no_overlap(symgen: &SymGen) -> Result<(), String> {
             }
             Ok(())
         }
+        /// Sweeps over both sets of extents in order of start address, in O(n log n) time. Extents
+        /// within each set are allowed to overlap with each other. Whenever the current extent of
+        /// one set ends before the current extent of the other set starts, it can't overlap with
+        /// any later extent in the other set either, so it can be skipped.
         fn check_exts_for_mutual_overlap(
             exts1: &mut [(Extent, &str)],
             exts2: &mut [(Extent, &str)],
@@ -976,6 +985,121 @@ pub fn run_checks<P: AsRef<Path>>(
         .collect())
 }
 
+/// The results of [`run_checks`] for a single input file.
+type FileCheckResults = Result<Vec<(PathBuf, CheckResult)>, Box<dyn Error>>;
+
+/// Runs [`run_checks`] on each of the `input_files`, on up to `jobs` threads.
+///
+/// Each input file (along with its subregion files in `recursive` mode) is parsed and checked
+/// independently on a single worker thread. The returned results are in the same order as
+/// `input_files`, regardless of the order in which the workers finish.
+///
+/// Work is split per file rather than per check. A parsed file could be shared between workers
+/// through an [`Arc`](std::sync::Arc), as `gen` does, but a project usually has many more input
+/// files than worker threads, so splitting up the checks for a single file wouldn't buy much.
+fn run_checks_concurrently(
+    input_files: Vec<PathBuf>,
+    checks: &[Check],
+    recursive: bool,
+    jobs: usize,
+) -> Vec<FileCheckResults> {
+    let checks = checks.to_vec();
+    // Box<dyn Error> isn't Send, so errors are passed back as messages
+    util::parallel_map(input_files, jobs, move |f| {
+        run_checks(f, &checks, recursive).map_err(|e| e.to_string())
+    })
+    .into_iter()
+    .map(|r| r.map_err(|e| e.into()))
+    .collect()
+}
+
+/// A check result (along with the file it applies to) in the form stored in a [`ResultCache`].
+#[derive(Debug, Serialize, Deserialize)]
+struct CachedCheckResult {
+    path: PathBuf,
+    /// Index into the list of checks that were run, or `None` for the implicit
+    /// [`Check::UniqueSymbolsAcrossSubregions`] check.
+    check: Option<usize>,
+    succeeded: bool,
+    details: Option<String>,
+}
+
+impl CachedCheckResult {
+    fn new(path: &Path, result: &CheckResult, checks: &[Check]) -> Self {
+        Self {
+            path: path.to_owned(),
+            check: checks.iter().position(|c| *c == result.check),
+            succeeded: result.succeeded,
+            details: result.details.clone(),
+        }
+    }
+    fn to_result(&self, checks: &[Check]) -> Option<(PathBuf, CheckResult)> {
+        let check = match self.check {
+            Some(i) => checks.get(i)?.clone(),
+            None => Check::UniqueSymbolsAcrossSubregions,
+        };
+        Some((
+            self.path.clone(),
+            CheckResult {
+                check,
+                succeeded: self.succeeded,
+                details: self.details.clone(),
+            },
+        ))
+    }
+}
+
+/// Same as [`run_checks_concurrently`], but reuses the results for input files that are
+/// unchanged since they were stored in the `cache`, and stores the results for all other files.
+fn run_checks_cached(
+    input_files: &[PathBuf],
+    checks: &[Check],
+    recursive: bool,
+    jobs: usize,
+    cache: &mut ResultCache<Vec<CachedCheckResult>>,
+) -> Vec<FileCheckResults> {
+    let config = format!("check {:?}", checks);
+    let mut results: Vec<Option<FileCheckResults>> = Vec::with_capacity(input_files.len());
+    // (index into input_files, cache key) for each file that needs to be checked
+    let mut misses = Vec::new();
+    for (i, input_file) in input_files.iter().enumerate() {
+        // If the key can't be computed, the file probably can't be read. Check the file anyway so
+        // that the error is reported as usual.
+        let key = cache::content_key(input_file, recursive, &config).ok();
+        let hit = key
+            .as_ref()
+            .and_then(|k| cache.get(input_file, k))
+            .and_then(|cached| cached.iter().map(|r| r.to_result(checks)).collect());
+        if hit.is_none() {
+            misses.push((i, key));
+        }
+        results.push(hit.map(Ok));
+    }
+
+    let miss_files = misses
+        .iter()
+        .map(|&(i, _)| input_files[i].clone())
+        .collect();
+    let miss_results = run_checks_concurrently(miss_files, checks, recursive, jobs);
+    for ((i, key), result) in misses.into_iter().zip(miss_results) {
+        if let (Some(key), Ok(file_results)) = (key, &result) {
+            cache.insert(
+                &input_files[i],
+                key,
+                file_results
+                    .iter()
+                    .map(|(p, r)| CachedCheckResult::new(p, r, checks))
+                    .collect(),
+            );
+        }
+        results[i] = Some(result);
+    }
+    results
+        .into_iter()
+        .map(|r| r.expect("input file was neither cached nor checked"))
+        .collect()
+}
+
 /// Prints check results similar to `cargo test` output.
 fn print_report(results: &[(PathBuf, CheckResult)]) -> io::Result<()> {
     let mut stdout = StandardStream::stdout(ColorChoice::Always);
@@ -1062,19 +1186,65 @@ where
     P: AsRef<Path>,
     I: AsRef<[P]>,
 {
-    let input_files = input_files.as_ref();
+    run_and_print_checks_parallel(input_files, checks, recursive, 1, None)
+}
+
+/// Same as [`run_and_print_checks`], but validates up to `jobs` input files concurrently.
+///
+/// If a `cache_file` is given, results are cached there between runs, and files that haven't
+/// changed since their results were cached (along with their subregion files in `recursive`
+/// mode) aren't checked again.
+///
+/// The printed report is identical to that of [`run_and_print_checks`], regardless of `jobs`
+/// and caching.
+///
+/// # Examples
+/// ```ignore
+/// let passed = run_and_print_checks_parallel(
+///     ["/path/to/symbols.yml", "/path/to/other_symbols.yml"],
+///     &[Check::ExplicitVersions, Check::NoOverlap],
+///     true,
+///     4,
+///     Some(Path::new("target/resymgen-cache/check.json")),
+/// )
+/// .expect("Fatal error occurred");
+/// ```
+pub fn run_and_print_checks_parallel<I, P>(
+    input_files: I,
+    checks: &[Check],
+    recursive: bool,
+    jobs: usize,
+    cache_file: Option<&Path>,
+) -> Result<bool, Box<dyn Error>>
+where
+    P: AsRef<Path>,
+    I: AsRef<[P]>,
+{
+    let input_files: Vec<PathBuf> = input_files
+        .as_ref()
+        .iter()
+        .map(|p| p.as_ref().to_owned())
+        .collect();
     // At least this many check results, but there could be more in recursive mode
     let mut results = Vec::with_capacity(input_files.len() * checks.len());
     let mut errors = Vec::with_capacity(input_files.len());
-    for input_file in input_files {
-        match run_checks(input_file, checks, recursive) {
+    let mut cache = cache_file.map(ResultCache::load);
+    let file_results = match cache.as_mut() {
+        Some(cache) => run_checks_cached(&input_files, checks, recursive, jobs, cache),
+        None => run_checks_concurrently(input_files.clone(), checks, recursive, jobs),
+    };
+    for (input_file, file_result) in input_files.iter().zip(file_results) {
+        match file_result {
             Ok(result) => results.extend(result.into_iter()),
-            Err(e) => errors.push((input_file.as_ref().to_string_lossy().into_owned(), e)),
+            Err(e) => errors.push((input_file.to_string_lossy().into_owned(), e)),
         }
     }
 
     // Best-effort: print what we have, even if some checks errored
     print_report(&results)?;
+    if let Some(cache) = cache.as_mut() {
+        cache.save()?;
+    }
 
     if !errors.is_empty() {
         return Err(MultiFileError {
@@ -1088,7 +1258,7 @@ where
 
 #[cfg(test)]
 mod tests {
-    use super::super::data_formats::symgen_yml::test_utils;
+    use super::super::data_formats::symgen_yml::{test_utils, IntFormat};
     use super::*;
 
     #[cfg(test)]
@@ -1702,6 +1872,127 @@ mod tests {
         assert!(check_no_overlap(&symgen).is_err());
     }
 
+    #[test]
+    fn test_no_overlap_with_subregions_nested_symbols() {
+        let mut symgen = get_test_symgen_with_subregions();
+        let data = |name: &str, address: Uint, length: Uint| Symbol {
+            name: String::from(name),
+            aliases: None,
+            address: MaybeVersionDep::ByVersion([("v2".into(), [address].into())].into()),
+            length: Some(MaybeVersionDep::ByVersion([("v2".into(), length)].into())),
+            description: None,
+        };
+
+        // Data symbols can overlap each other, as long as they don't overlap a subregion.
+        // sub2 covers 0x20FFF00-0x20FFFFF in v2.
+        let block = get_main_block(&mut symgen);
+        block.data.push(data("outer", 0x20FF000, 0x800));
+        block.data.push(data("inner", 0x20FF100, 0x10));
+        assert!(check_no_overlap(&symgen).is_ok());
+
+        // The overlap should be found even when it comes after other (nested) symbols
+        let block = get_main_block(&mut symgen);
+        block.data.push(data("straddle", 0x20FFE00, 0x200));
+        let err = check_no_overlap(&symgen).expect_err("overlap not detected");
+        assert!(err.contains("straddle"));
+    }
+
+    #[test]
+    fn test_run_checks_concurrently() {
+        let checks = [
+            Check::NoOverlap,
+            Check::DataNames([NamingConvention::ScreamingSnakeCase].into()),
+        ];
+        let mut files = Vec::new();
+        for i in 0..5 {
+            let mut symgen = get_test_symgen();
+            if i % 2 == 1 {
+                get_main_block(&mut symgen)
+                    .data
+                    .get_mut(0)
+                    .expect("symgen has no data")
+                    .name = format!("data_{}", i);
+            }
+            let f = tempfile::NamedTempFile::new().expect("Failed to create temp file");
+            symgen
+                .write(f.as_file(), IntFormat::Hexadecimal)
+                .expect("Failed to write temp file");
+            files.push(f);
+        }
+        let mut paths: Vec<PathBuf> = files.iter().map(|f| f.path().to_owned()).collect();
+        paths.insert(2, PathBuf::from("/nonexistent/symbols.yml"));
+
+        let summarize = |results: Vec<FileCheckResults>| {
+            results
+                .into_iter()
+                .map(|r| {
+                    r.map(|rs| {
+                        rs.into_iter()
+                            .map(|(p, r)| (p, r.check.to_string(), r.succeeded, r.details))
+                            .collect::<Vec<_>>()
+                    })
+                    .map_err(|e| e.to_string())
+                })
+                .collect::<Vec<_>>()
+        };
+        let sequential = summarize(run_checks_concurrently(paths.clone(), &checks, true, 1));
+        assert_eq!(sequential.len(), paths.len());
+        assert!(sequential[2].is_err());
+        assert!(sequential[1].as_ref().unwrap().iter().any(|r| !r.2));
+        assert!(sequential[0].as_ref().unwrap().iter().all(|r| r.2));
+        for jobs in [2, 3, 16] {
+            let parallel = summarize(run_checks_concurrently(paths.clone(), &checks, true, jobs));
+            assert_eq!(parallel, sequential);
+        }
+    }
+
+    #[test]
+    fn test_run_checks_cached() {
+        let checks = [Check::NoOverlap, Check::UniqueSymbols];
+        let dir = tempfile::tempdir().expect("Failed to create temp dir");
+        let input_file = dir.path().join("symbols.yml");
+        get_test_symgen()
+            .write(File::create(&input_file).unwrap(), IntFormat::Hexadecimal)
+            .expect("Failed to write symbols");
+        let input_files = [input_file.clone()];
+        let mut cache = ResultCache::load(dir.path().join("cache.json"));
+
+        let results = run_checks_cached(&input_files, &checks, true, 1, &mut cache);
+        let results = results[0].as_ref().expect("checks failed to run");
+        assert_eq!(results.len(), checks.len());
+        assert!(results.iter().all(|(_, r)| r.succeeded));
+
+        // Plant a fake result to make sure the cache is actually used
+        let config = format!("check {:?}", checks);
+        let key = cache::content_key(&input_file, true, &config).unwrap();
+        cache.insert(
+            &input_file,
+            key,
+            vec![CachedCheckResult {
+                path: input_file.clone(),
+                check: Some(1),
+                succeeded: false,
+                details: Some("cached".to_string()),
+            }],
+        );
+        let results = run_checks_cached(&input_files, &checks, true, 1, &mut cache);
+        let results = results[0].as_ref().expect("checks failed to run");
+        assert_eq!(results.len(), 1);
+        assert_eq!(results[0].1.check, Check::UniqueSymbols);
+        assert_eq!(results[0].1.details.as_deref(), Some("cached"));
+
+        // Changing the file should invalidate the cached result
+        let mut symgen = get_test_symgen();
+        get_main_block(&mut symgen).description = Some("changed".to_string());
+        symgen
+            .write(File::create(&input_file).unwrap(), IntFormat::Hexadecimal)
+            .expect("Failed to write symbols");
+        let results = run_checks_cached(&input_files, &checks, true, 1, &mut cache);
+        let results = results[0].as_ref().expect("checks failed to run");
+        assert_eq!(results.len(), checks.len());
+        assert!(results.iter().all(|(_, r)| r.succeeded));
+    }
+
     #[test]
     fn test_symbols_name_check() {
         let mut symgen = get_test_symgen();
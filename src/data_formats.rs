@@ -4,10 +4,14 @@
 //! The code for each data format is separated into its own module, including the `resymgen` YAML
 //! format itself (the [`symgen_yml`] module).
 
+pub mod c_header;
 pub mod ghidra;
 pub mod ghidra_csv;
 pub mod json;
+pub mod ld_free;
+pub mod ld_script;
 pub mod sym;
+pub mod sym_index;
 pub mod symgen_yml;
 
 use std::error::Error;
@@ -15,11 +19,15 @@ use std::fs::File;
 use std::io::{Read, Write};
 use std::path::Path;
 
-use ghidra::GhidraFormatter;
+use c_header::{CHeaderBlockWriter, CHeaderFormatter};
+use ghidra::{GhidraBlockWriter, GhidraFormatter};
 use ghidra_csv::CsvLoader;
-use json::JsonFormatter;
-use sym::SymFormatter;
-pub use symgen_yml::Generate;
+use json::{JsonBlockWriter, JsonFormatter};
+use ld_free::{LdFreeBlockWriter, LdFreeFormatter};
+use ld_script::{LdScriptBlockWriter, LdScriptFormatter};
+use sym::{SymBlockWriter, SymFormatter};
+use sym_index::{SymIndexBlockWriter, SymIndexFormatter};
+pub use symgen_yml::{BlockWriter, Generate};
 use symgen_yml::{Load, LoadParams, Subregion, SymGen, Symbol};
 
 // `OutFormat` is like a poor man's version of trait objects for Generate. Real trait objects don't
@@ -39,6 +47,14 @@ pub enum OutFormat {
     Sym,
     /// [`json`] format
     Json,
+    /// [`ld_free`] format
+    LdFree,
+    /// [`sym_index`] format
+    SymIndex,
+    /// [`ld_script`] format
+    LdScript,
+    /// [`c_header`] format
+    CHeader,
 }
 
 // Technically this makes it redundant to impl Generate for the individual formatters, but I think
@@ -54,6 +70,10 @@ impl Generate for OutFormat {
             Self::Ghidra => GhidraFormatter {}.generate(writer, symgen, version),
             Self::Sym => SymFormatter {}.generate(writer, symgen, version),
             Self::Json => JsonFormatter {}.generate(writer, symgen, version),
+            Self::LdFree => LdFreeFormatter {}.generate(writer, symgen, version),
+            Self::SymIndex => SymIndexFormatter {}.generate(writer, symgen, version),
+            Self::LdScript => LdScriptFormatter {}.generate(writer, symgen, version),
+            Self::CHeader => CHeaderFormatter {}.generate(writer, symgen, version),
         }
     }
 }
@@ -65,6 +85,10 @@ impl OutFormat {
             "ghidra" => Some(Self::Ghidra),
             "sym" => Some(Self::Sym),
             "json" => Some(Self::Json),
+            "ldfree" => Some(Self::LdFree),
+            "symidx" => Some(Self::SymIndex),
+            "ld" => Some(Self::LdScript),
+            "h" => Some(Self::CHeader),
             _ => None,
         }
     }
@@ -74,12 +98,52 @@ impl OutFormat {
             Self::Ghidra => String::from("ghidra"),
             Self::Sym => String::from("sym"),
             Self::Json => String::from("json"),
+            Self::LdFree => String::from("ldfree"),
+            Self::SymIndex => String::from("symidx"),
+            Self::LdScript => String::from("ld"),
+            Self::CHeader => String::from("h"),
         }
     }
     /// Returns an [`Iterator`] over all [`OutFormat`] variants.
     pub fn all() -> impl Iterator<Item = OutFormat> {
+        [
+            Self::Ghidra,
+            Self::Sym,
+            Self::Json,
+            Self::LdFree,
+            Self::SymIndex,
+            Self::LdScript,
+            Self::CHeader,
+        ]
+        .iter()
+        .copied()
+    }
+    /// Returns an [`Iterator`] over the [`OutFormat`] variants generated by default, when no
+    /// formats are specified explicitly. The other formats are only generated on request.
+    pub fn defaults() -> impl Iterator<Item = OutFormat> {
         [Self::Ghidra, Self::Sym, Self::Json].iter().copied()
     }
+    /// Returns a [`BlockWriter`] that incrementally writes the symbol table for `version` to
+    /// `writer` in the format specified by the [`OutFormat`].
+    ///
+    /// For the [`ghidra`], [`json`], [`ld_script`], and [`c_header`] formats, the output of a
+    /// [`BlockWriter`] is grouped by block, so it only matches the output of [`Generate`] for
+    /// symbol tables with a single block.
+    pub fn block_writer<'w, W: Write + 'w>(
+        &self,
+        writer: W,
+        version: &str,
+    ) -> Result<Box<dyn BlockWriter + 'w>, Box<dyn Error>> {
+        Ok(match self {
+            Self::Ghidra => Box::new(GhidraBlockWriter::new(writer, version)),
+            Self::Sym => Box::new(SymBlockWriter::new(writer, version)),
+            Self::Json => Box::new(JsonBlockWriter::new(writer, version)?),
+            Self::LdFree => Box::new(LdFreeBlockWriter::new(writer, version)?),
+            Self::SymIndex => Box::new(SymIndexBlockWriter::new(writer, version)),
+            Self::LdScript => Box::new(LdScriptBlockWriter::new(writer, version)),
+            Self::CHeader => Box::new(CHeaderBlockWriter::new(writer, version)?),
+        })
+    }
 }
 
 /// Input formats that can be merged into a symbol table in the [`resymgen` YAML] format
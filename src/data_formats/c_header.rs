@@ -0,0 +1,261 @@
+//! A C header of symbol address constants (.h).
+//!
+//! Each symbol (and each alias) gets an `ADDR_`-prefixed `#define` with its address, so C code
+//! and assembly can refer to addresses directly without going through the linker. Symbols with a
+//! known length also get a `SIZE_`-prefixed `#define`.
+//!
+//! If `RESYMGEN_DECLARE_SYMBOLS` is defined before including the header, it also declares every
+//! symbol as an `extern` byte array, for code that links against the symbols (e.g., with the
+//! [ld] format) but doesn't have proper declarations for them. These declarations are opt-in,
+//! since they would conflict with proper declarations of the same symbols.
+//!
+//! Only functions and data are defined; blocks themselves don't get a constant. Names that aren't
+//! valid C identifiers are skipped. As with the [ld] format, each name is only defined once, at its
+//! first address, and any later occurrences of the same name within a version (further addresses
+//! of the same symbol, or the same name in more than one block) are listed in a comment instead.
+//!
+//! [ld]: super::ld_script
+//!
+//! # Example
+//! ```c
+//! #pragma once
+//!
+//! #define ADDR_function1 0x02400000
+//! #define ADDR_function2 0x02401000
+//! /* function2 also at 0x02402000 */
+//! #define ADDR_SOME_DATA 0x02FFFFFF
+//! #define SIZE_SOME_DATA 0x4
+//!
+//! #ifdef RESYMGEN_DECLARE_SYMBOLS
+//! extern char function1[];
+//! extern char function2[];
+//! extern char SOME_DATA[];
+//! #endif
+//! ```
+
+use std::collections::HashSet;
+use std::error::Error;
+use std::io::Write;
+use std::iter;
+
+use super::symgen_yml::{Block, BlockWriter, Generate, RealizedSymbol, SymGen};
+
+/// Generator for the .h format.
+pub struct CHeaderFormatter {}
+
+/// Returns whether `name` is a valid C identifier.
+fn is_c_identifier(name: &str) -> bool {
+    let mut chars = name.chars();
+    matches!(chars.next(), Some(c) if c.is_ascii_alphabetic() || c == '_')
+        && chars.all(|c| c.is_ascii_alphanumeric() || c == '_')
+}
+
+/// Names defined so far in a header, in order.
+#[derive(Default)]
+struct Defined {
+    names: Vec<String>,
+    seen: HashSet<String>,
+}
+
+fn write_preamble<W: Write>(mut writer: W) -> Result<(), Box<dyn Error>> {
+    writeln!(writer, "#pragma once\n")?;
+    Ok(())
+}
+
+/// Writes `#define`s for `symbols` (and their aliases).
+fn write_defines<'s, W, I>(
+    mut writer: W,
+    symbols: I,
+    defined: &mut Defined,
+) -> Result<(), Box<dyn Error>>
+where
+    W: Write,
+    I: Iterator<Item = RealizedSymbol<'s>>,
+{
+    for s in symbols {
+        let aliases = s.aliases.unwrap_or(&[]).iter().map(|a| a.as_str());
+        for name in iter::once(s.name).chain(aliases) {
+            if !is_c_identifier(name) {
+                continue;
+            }
+            if defined.seen.contains(name) {
+                writeln!(writer, "/* {} also at {:#010X} */", name, s.address)?;
+                continue;
+            }
+            writeln!(writer, "#define ADDR_{} {:#010X}", name, s.address)?;
+            if let Some(length) = s.length {
+                writeln!(writer, "#define SIZE_{} {:#X}", name, length)?;
+            }
+            defined.seen.insert(name.to_string());
+            defined.names.push(name.to_string());
+        }
+    }
+    Ok(())
+}
+
+/// Writes the opt-in `extern` declarations for all the `defined` names.
+fn write_declarations<W: Write>(mut writer: W, defined: &Defined) -> Result<(), Box<dyn Error>> {
+    writeln!(writer, "\n#ifdef RESYMGEN_DECLARE_SYMBOLS")?;
+    for name in defined.names.iter() {
+        writeln!(writer, "extern char {}[];", name)?;
+    }
+    writeln!(writer, "#endif")?;
+    Ok(())
+}
+
+impl Generate for CHeaderFormatter {
+    fn generate<W: Write>(
+        &self,
+        mut writer: W,
+        symgen: &SymGen,
+        version: &str,
+    ) -> Result<(), Box<dyn Error>> {
+        let mut defined = Defined::default();
+        write_preamble(&mut writer)?;
+        write_defines(
+            &mut writer,
+            symgen.functions_realized(version),
+            &mut defined,
+        )?;
+        write_defines(&mut writer, symgen.data_realized(version), &mut defined)?;
+        write_declarations(&mut writer, &defined)
+    }
+}
+
+/// Incremental [`BlockWriter`] for the .h format.
+///
+/// Unlike [`CHeaderFormatter`], which lists all functions before all data, this lists the
+/// functions and then the data of each block in turn. The output is only the same for symbol
+/// tables with a single block.
+pub struct CHeaderBlockWriter<W: Write> {
+    writer: W,
+    version: String,
+    defined: Defined,
+}
+
+impl<W: Write> CHeaderBlockWriter<W> {
+    pub fn new(mut writer: W, version: &str) -> Result<Self, Box<dyn Error>> {
+        write_preamble(&mut writer)?;
+        Ok(Self {
+            writer,
+            version: version.to_string(),
+            defined: Defined::default(),
+        })
+    }
+}
+
+impl<W: Write> BlockWriter for CHeaderBlockWriter<W> {
+    fn write_block(&mut self, _block_name: &str, block: &Block) -> Result<(), Box<dyn Error>> {
+        write_defines(
+            &mut self.writer,
+            block.functions_realized(&self.version),
+            &mut self.defined,
+        )?;
+        write_defines(
+            &mut self.writer,
+            block.data_realized(&self.version),
+            &mut self.defined,
+        )
+    }
+    fn finish(mut self: Box<Self>) -> Result<(), Box<dyn Error>> {
+        write_declarations(&mut self.writer, &self.defined)?;
+        self.writer.flush()?;
+        Ok(())
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn get_test_symgen() -> SymGen {
+        SymGen::read(
+            r"
+            main:
+              versions:
+                - v1
+                - v2
+              address:
+                v1: 0x2000000
+                v2: 0x2000000
+              length:
+                v1: 0x100000
+                v2: 0x100000
+              functions:
+                - name: fn1
+                  aliases:
+                    - fn1_alias
+                  address:
+                    v1: 0x2000000
+                    v2: 0x2002000
+                  length:
+                    v1: 0x1000
+                    v2: 0x1000
+                - name: fn2
+                  address:
+                    v1:
+                      - 0x2001000
+                      - 0x2002000
+                    v2: 0x2003000
+                - name: operator new
+                  address:
+                    v1: 0x2004000
+              data:
+                - name: SOME_DATA
+                  address:
+                    v1: 0x2003000
+                    v2: 0x2004000
+                  length:
+                    v1: 0x1000
+                    v2: 0x2000
+        "
+            .as_bytes(),
+        )
+        .expect("Read failed")
+    }
+
+    #[test]
+    fn test_generate() {
+        let symgen = get_test_symgen();
+        let f = CHeaderFormatter {};
+        assert_eq!(
+            f.generate_str(&symgen, "v1").expect("generate failed"),
+            concat!(
+                "#pragma once\n\n",
+                "#define ADDR_fn1 0x02000000\n",
+                "#define SIZE_fn1 0x1000\n",
+                "#define ADDR_fn1_alias 0x02000000\n",
+                "#define SIZE_fn1_alias 0x1000\n",
+                "#define ADDR_fn2 0x02001000\n",
+                "/* fn2 also at 0x02002000 */\n",
+                "#define ADDR_SOME_DATA 0x02003000\n",
+                "#define SIZE_SOME_DATA 0x1000\n",
+                "\n#ifdef RESYMGEN_DECLARE_SYMBOLS\n",
+                "extern char fn1[];\n",
+                "extern char fn1_alias[];\n",
+                "extern char fn2[];\n",
+                "extern char SOME_DATA[];\n",
+                "#endif\n",
+            )
+        );
+        assert_eq!(
+            f.generate_str(&symgen, "v2").expect("generate failed"),
+            concat!(
+                "#pragma once\n\n",
+                "#define ADDR_fn1 0x02002000\n",
+                "#define SIZE_fn1 0x1000\n",
+                "#define ADDR_fn1_alias 0x02002000\n",
+                "#define SIZE_fn1_alias 0x1000\n",
+                "#define ADDR_fn2 0x02003000\n",
+                "#define ADDR_SOME_DATA 0x02004000\n",
+                "#define SIZE_SOME_DATA 0x2000\n",
+                "\n#ifdef RESYMGEN_DECLARE_SYMBOLS\n",
+                "extern char fn1[];\n",
+                "extern char fn1_alias[];\n",
+                "extern char fn2[];\n",
+                "extern char SOME_DATA[];\n",
+                "#endif\n",
+            )
+        );
+    }
+}
@@ -15,15 +15,15 @@
 use std::error::Error;
 use std::io::Write;
 
-use csv::WriterBuilder;
+use csv::{Writer, WriterBuilder};
 use serde::{Serialize, Serializer};
 
-use super::symgen_yml::{Generate, SymGen, Uint};
+use super::symgen_yml::{Block, BlockWriter, Generate, RealizedSymbol, SymGen, Uint};
 
 /// Generator for the .ghidra format.
 pub struct GhidraFormatter {}
 
-#[derive(Debug)]
+#[derive(Debug, Clone, Copy)]
 enum SymbolType {
     Function,
     Label,
@@ -56,6 +56,42 @@ struct Entry<'a> {
     stype: SymbolType,
 }
 
+/// Writes `symbols` (and their aliases) with the given symbol type to `wtr`.
+fn write_symbols<'s, W, I>(
+    wtr: &mut Writer<W>,
+    symbols: I,
+    stype: SymbolType,
+) -> Result<(), Box<dyn Error>>
+where
+    W: Write,
+    I: Iterator<Item = RealizedSymbol<'s>>,
+{
+    for s in symbols {
+        wtr.serialize(Entry {
+            name: s.name,
+            address: s.address,
+            stype,
+        })?;
+        if let Some(aliases) = s.aliases {
+            for alias in aliases {
+                wtr.serialize(Entry {
+                    name: alias,
+                    address: s.address,
+                    stype,
+                })?;
+            }
+        }
+    }
+    Ok(())
+}
+
+fn csv_writer<W: Write>(writer: W) -> Writer<W> {
+    WriterBuilder::new()
+        .delimiter(b' ')
+        .has_headers(false)
+        .from_writer(writer)
+}
+
 impl Generate for GhidraFormatter {
     fn generate<W: Write>(
         &self,
@@ -63,42 +99,51 @@ impl Generate for GhidraFormatter {
         symgen: &SymGen,
         version: &str,
     ) -> Result<(), Box<dyn Error>> {
-        let mut wtr = WriterBuilder::new()
-            .delimiter(b' ')
-            .has_headers(false)
-            .from_writer(writer);
-        for f in symgen.functions_realized(version) {
-            wtr.serialize(Entry {
-                name: f.name,
-                address: f.address,
-                stype: SymbolType::Function,
-            })?;
-            if let Some(aliases) = f.aliases {
-                for alias in aliases {
-                    wtr.serialize(Entry {
-                        name: alias,
-                        address: f.address,
-                        stype: SymbolType::Function,
-                    })?;
-                }
-            }
-        }
-        for d in symgen.data_realized(version) {
-            wtr.serialize(Entry {
-                name: d.name,
-                address: d.address,
-                stype: SymbolType::Label,
-            })?;
-            if let Some(aliases) = d.aliases {
-                for alias in aliases {
-                    wtr.serialize(Entry {
-                        name: alias,
-                        address: d.address,
-                        stype: SymbolType::Label,
-                    })?;
-                }
-            }
+        let mut wtr = csv_writer(writer);
+        write_symbols(
+            &mut wtr,
+            symgen.functions_realized(version),
+            SymbolType::Function,
+        )?;
+        write_symbols(&mut wtr, symgen.data_realized(version), SymbolType::Label)?;
+        Ok(())
+    }
+}
+
+/// Incremental [`BlockWriter`] for the .ghidra format.
+///
+/// Unlike [`GhidraFormatter`], which lists all functions before all data, this lists the
+/// functions and then the data of each block in turn. The output is only the same for symbol
+/// tables with a single block.
+pub struct GhidraBlockWriter<W: Write> {
+    wtr: Writer<W>,
+    version: String,
+}
+
+impl<W: Write> GhidraBlockWriter<W> {
+    pub fn new(writer: W, version: &str) -> Self {
+        Self {
+            wtr: csv_writer(writer),
+            version: version.to_string(),
         }
+    }
+}
+
+impl<W: Write> BlockWriter for GhidraBlockWriter<W> {
+    fn write_block(&mut self, _block_name: &str, block: &Block) -> Result<(), Box<dyn Error>> {
+        write_symbols(
+            &mut self.wtr,
+            block.functions_realized(&self.version),
+            SymbolType::Function,
+        )?;
+        write_symbols(
+            &mut self.wtr,
+            block.data_realized(&self.version),
+            SymbolType::Label,
+        )
+    }
+    fn finish(mut self: Box<Self>) -> Result<(), Box<dyn Error>> {
+        self.wtr.flush()?;
         Ok(())
     }
 }
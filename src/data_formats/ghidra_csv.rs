@@ -17,43 +17,53 @@
 
 use std::error::Error;
 use std::io::Read;
+use std::str;
 use std::vec::IntoIter;
 
-use csv::{self, ReaderBuilder};
-use serde::{de, Deserialize, Deserializer};
+use csv::{ByteRecord, ReaderBuilder};
 
 use super::symgen_yml::{AddSymbol, Load, LoadParams, MaybeVersionDep, Symbol, SymbolType, Uint};
 
-fn deserialize_hex<'de, D>(deserializer: D) -> Result<Uint, D::Error>
-where
-    D: Deserializer<'de>,
-{
-    let hex_str: &str = Deserialize::deserialize(deserializer)?;
-    Uint::from_str_radix(hex_str, 16).map_err(de::Error::custom)
+/// Column indexes of the fields within a row.
+struct Columns {
+    name: usize,
+    location: usize,
+    stype: usize,
 }
 
-fn deserialize_symbol_type<'de, D>(deserializer: D) -> Result<Option<SymbolType>, D::Error>
-where
-    D: Deserializer<'de>,
-{
-    let type_str: &str = Deserialize::deserialize(deserializer)?;
-    Ok(match type_str {
-        "Function" => Some(SymbolType::Function),
-        "Data Label" => Some(SymbolType::Data),
+impl Columns {
+    fn from_headers(headers: &ByteRecord) -> Result<Self, Box<dyn Error>> {
+        let find = |header: &str| {
+            headers
+                .iter()
+                .position(|h| h == header.as_bytes())
+                .ok_or_else(|| format!("missing field `{}`", header))
+        };
+        Ok(Self {
+            name: find("Name")?,
+            location: find("Location")?,
+            stype: find("Type")?,
+        })
+    }
+}
+
+fn parse_symbol_type(type_bytes: &[u8]) -> Option<SymbolType> {
+    match type_bytes {
+        b"Function" => Some(SymbolType::Function),
+        b"Data Label" => Some(SymbolType::Data),
         _ => None,
-    })
+    }
 }
 
-#[derive(Debug, Deserialize)]
-struct RawEntry {
-    #[serde(rename = "Name")]
-    name: String,
-    #[serde(rename = "Location")]
-    #[serde(deserialize_with = "deserialize_hex")]
-    location: Uint,
-    #[serde(rename = "Type")]
-    #[serde(deserialize_with = "deserialize_symbol_type")]
-    stype: Option<SymbolType>, // None means an unknown/unsupported symbol type
+fn parse_hex(hex_bytes: &[u8]) -> Result<Uint, Box<dyn Error>> {
+    Ok(Uint::from_str_radix(str::from_utf8(hex_bytes)?, 16)?)
+}
+
+fn field(record: &ByteRecord, i: usize) -> Result<&[u8], Box<dyn Error>> {
+    record.get(i).ok_or_else(|| {
+        let line = record.position().map_or(0, |p| p.line());
+        format!("line {}: expected at least {} fields", line, i + 1).into()
+    })
 }
 
 #[derive(Debug)]
@@ -70,21 +80,27 @@ pub struct CsvLoader {
 }
 
 impl CsvLoader {
-    fn read<R: Read>(rdr: R) -> Result<Vec<Entry>, csv::Error> {
+    fn read<R: Read>(rdr: R) -> Result<Vec<Entry>, Box<dyn Error>> {
         let mut csv_rdr = ReaderBuilder::new()
             .double_quote(false)
             .escape(Some(b'\\'))
             .from_reader(rdr);
+        let columns = Columns::from_headers(csv_rdr.byte_headers()?)?;
+        // Rows are parsed from a single reused record buffer, and only the names of symbols that
+        // are actually kept get copied out.
+        let mut record = ByteRecord::new();
         let mut symbols = Vec::new();
-        for result in csv_rdr.deserialize() {
-            let mut raw: RawEntry = result?;
-            if let Some(stype) = raw.stype.take() {
-                symbols.push(Entry {
-                    name: raw.name,
-                    location: raw.location,
-                    stype,
-                })
-            }
+        while csv_rdr.read_byte_record(&mut record)? {
+            let location = parse_hex(field(&record, columns.location)?)?;
+            let stype = match parse_symbol_type(field(&record, columns.stype)?) {
+                Some(stype) => stype,
+                None => continue, // unknown/unsupported symbol type
+            };
+            symbols.push(Entry {
+                name: str::from_utf8(field(&record, columns.name)?)?.to_string(),
+                location,
+                stype,
+            });
         }
         Ok(symbols)
     }
@@ -227,4 +243,43 @@ mod tests {
         );
         assert_eq!(iter.next(), None);
     }
+
+    #[test]
+    fn test_load_reordered_columns_and_unknown_types() {
+        let contents = r#""Type","Location","Name"
+"Function","2000000","fn1"
+"Parameter","2000004","param1"
+"Data Label","2010000","SOME_DATA""#;
+        let params = LoadParams {
+            default_block_name: None,
+            default_symbol_type: None,
+            default_version_name: None,
+        };
+        let names: Vec<_> = CsvLoader::load(contents.as_bytes(), &params)
+            .expect("load failed")
+            .map(|s| (s.symbol.name, s.stype))
+            .collect();
+        assert_eq!(
+            names,
+            [
+                ("fn1".to_string(), SymbolType::Function),
+                ("SOME_DATA".to_string(), SymbolType::Data)
+            ]
+        );
+    }
+
+    #[test]
+    fn test_load_invalid() {
+        let params = LoadParams {
+            default_block_name: None,
+            default_symbol_type: None,
+            default_version_name: None,
+        };
+        let missing_column = r#""Name","Type"
+"fn1","Function""#;
+        assert!(CsvLoader::load(missing_column.as_bytes(), &params).is_err());
+        let bad_location = r#""Name","Location","Type"
+"fn1","not hex","Function""#;
+        assert!(CsvLoader::load(bad_location.as_bytes(), &params).is_err());
+    }
 }
@@ -35,12 +35,12 @@ use std::io::Write;
 
 use serde::Serialize;
 
-use super::symgen_yml::{Generate, SymGen, Uint};
+use super::symgen_yml::{Block, BlockWriter, Generate, RealizedSymbol, SymGen, Uint};
 
 /// Generator for the .json format.
 pub struct JsonFormatter {}
 
-#[derive(Debug, Serialize)]
+#[derive(Debug, Clone, Copy, Serialize)]
 #[serde(rename_all = "lowercase")]
 enum SymbolType {
     Function,
@@ -61,6 +61,38 @@ struct Entry<'a> {
     description: Option<&'a str>,
 }
 
+/// Writes `symbols` with the given symbol type to `writer` as array elements. `needs_comma`
+/// tracks whether an element has already been written to the array.
+fn write_symbols<'s, W, I>(
+    mut writer: W,
+    symbols: I,
+    stype: SymbolType,
+    needs_comma: &mut bool,
+) -> Result<(), Box<dyn Error>>
+where
+    W: Write,
+    I: Iterator<Item = RealizedSymbol<'s>>,
+{
+    for s in symbols {
+        if *needs_comma {
+            writer.write_all(b",")?;
+        }
+        serde_json::to_writer(
+            &mut writer,
+            &Entry {
+                stype,
+                name: s.name,
+                aliases: s.aliases,
+                address: s.address,
+                length: s.length,
+                description: s.description,
+            },
+        )?;
+        *needs_comma = true;
+    }
+    Ok(())
+}
+
 impl Generate for JsonFormatter {
     fn generate<W: Write>(
         &self,
@@ -70,45 +102,67 @@ impl Generate for JsonFormatter {
     ) -> Result<(), Box<dyn Error>> {
         let mut needs_comma = false;
         writer.write_all(b"[")?;
-        for f in symgen.functions_realized(version) {
-            if needs_comma {
-                writer.write_all(b",")?;
-            }
-            serde_json::to_writer(
-                &mut writer,
-                &Entry {
-                    stype: SymbolType::Function,
-                    name: f.name,
-                    aliases: f.aliases,
-                    address: f.address,
-                    length: f.length,
-                    description: f.description,
-                },
-            )?;
-            needs_comma = true;
-        }
-        for d in symgen.data_realized(version) {
-            if needs_comma {
-                writer.write_all(b",")?;
-            }
-            serde_json::to_writer(
-                &mut writer,
-                &Entry {
-                    stype: SymbolType::Data,
-                    name: d.name,
-                    aliases: d.aliases,
-                    address: d.address,
-                    length: d.length,
-                    description: d.description,
-                },
-            )?;
-            needs_comma = true;
-        }
+        write_symbols(
+            &mut writer,
+            symgen.functions_realized(version),
+            SymbolType::Function,
+            &mut needs_comma,
+        )?;
+        write_symbols(
+            &mut writer,
+            symgen.data_realized(version),
+            SymbolType::Data,
+            &mut needs_comma,
+        )?;
         writer.write_all(b"]")?;
         Ok(())
     }
 }
 
+/// Incremental [`BlockWriter`] for the .json format.
+///
+/// Unlike [`JsonFormatter`], which lists all functions before all data, this lists the
+/// functions and then the data of each block in turn. The output is only the same for symbol
+/// tables with a single block.
+pub struct JsonBlockWriter<W: Write> {
+    writer: W,
+    version: String,
+    needs_comma: bool,
+}
+
+impl<W: Write> JsonBlockWriter<W> {
+    pub fn new(mut writer: W, version: &str) -> Result<Self, Box<dyn Error>> {
+        writer.write_all(b"[")?;
+        Ok(Self {
+            writer,
+            version: version.to_string(),
+            needs_comma: false,
+        })
+    }
+}
+
+impl<W: Write> BlockWriter for JsonBlockWriter<W> {
+    fn write_block(&mut self, _block_name: &str, block: &Block) -> Result<(), Box<dyn Error>> {
+        write_symbols(
+            &mut self.writer,
+            block.functions_realized(&self.version),
+            SymbolType::Function,
+            &mut self.needs_comma,
+        )?;
+        write_symbols(
+            &mut self.writer,
+            block.data_realized(&self.version),
+            SymbolType::Data,
+            &mut self.needs_comma,
+        )
+    }
+    fn finish(mut self: Box<Self>) -> Result<(), Box<dyn Error>> {
+        self.writer.write_all(b"]")?;
+        self.writer.flush()?;
+        Ok(())
+    }
+}
+
 #[cfg(test)]
 mod tests {
     use super::*;
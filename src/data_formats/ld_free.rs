@@ -0,0 +1,246 @@
+//! A GNU ld linker script fragment listing free address ranges (.ldfree).
+//!
+//! The fragment consists of a single `MEMORY` command. Each entry is an address range within a
+//! block that isn't covered by any symbol, named after the block and suffixed with `_free_` and
+//! an index. Symbols without an explicit length are conservatively assumed to extend up to the
+//! next symbol in the same block (or the end of the block), so only ranges following symbols with
+//! known lengths, or preceding the first symbol of a block, will ever be reported.
+//!
+//! Note that a free range just means that the range isn't annotated in the symbol tables; it
+//! doesn't guarantee that the memory is actually unused at runtime.
+//!
+//! # Example
+//! ```text
+//! MEMORY
+//! {
+//!   main_free_0 (rwx) : ORIGIN = 0x02000000, LENGTH = 0x1000
+//!   main_free_1 (rwx) : ORIGIN = 0x02003000, LENGTH = 0xFD000
+//! }
+//! ```
+
+use std::error::Error;
+use std::io::Write;
+
+use super::symgen_yml::{Block, BlockWriter, Generate, SymGen, Uint};
+
+/// Generator for the .ldfree format.
+pub struct LdFreeFormatter {}
+
+/// Computes the free ranges in `block` for the given version, as sorted, disjoint
+/// address-length pairs.
+fn free_ranges(block: &Block, version_name: &str) -> Vec<(Uint, Uint)> {
+    let version = block.version(version_name);
+    let (start, end) = match (block.address.get(version), block.length.get(version)) {
+        (Some(&addr), Some(&len)) => (addr, addr.saturating_add(len)),
+        _ => return Vec::new(),
+    };
+
+    let mut symbols: Vec<(Uint, Option<Uint>)> = block
+        .iter_realized(version_name)
+        .map(|s| (s.address, s.length))
+        .filter(|&(addr, _)| addr >= start && addr < end)
+        .collect();
+    symbols.sort_unstable();
+
+    // Walk the symbols in address order, tracking the end of the occupied region so far
+    let mut ranges = Vec::new();
+    let mut cursor = start;
+    for (i, &(addr, len)) in symbols.iter().enumerate() {
+        if addr > cursor {
+            ranges.push((cursor, addr - cursor));
+        }
+        let sym_end = match len {
+            Some(len) => addr.saturating_add(len),
+            None => symbols[i + 1..]
+                .iter()
+                .map(|&(a, _)| a)
+                .find(|&a| a > addr)
+                .unwrap_or(end),
+        };
+        cursor = cursor.max(sym_end.min(end));
+    }
+    if cursor < end {
+        ranges.push((cursor, end - cursor));
+    }
+    ranges
+}
+
+/// Converts a block name into a valid linker script memory region name prefix.
+fn region_prefix(block_name: &str) -> String {
+    block_name
+        .chars()
+        .map(|c| if c.is_ascii_alphanumeric() { c } else { '_' })
+        .collect()
+}
+
+/// Writes the free ranges in `block` for the given version to `writer`.
+fn write_block<W: Write>(
+    mut writer: W,
+    block_name: &str,
+    block: &Block,
+    version: &str,
+) -> Result<(), Box<dyn Error>> {
+    let prefix = region_prefix(block_name);
+    for (i, (addr, len)) in free_ranges(block, version).into_iter().enumerate() {
+        writeln!(
+            writer,
+            "  {}_free_{} (rwx) : ORIGIN = {:#010X}, LENGTH = {:#X}",
+            prefix, i, addr, len
+        )?;
+    }
+    Ok(())
+}
+
+impl Generate for LdFreeFormatter {
+    fn generate<W: Write>(
+        &self,
+        mut writer: W,
+        symgen: &SymGen,
+        version: &str,
+    ) -> Result<(), Box<dyn Error>> {
+        writeln!(writer, "MEMORY\n{{")?;
+        for (name, block) in symgen.iter() {
+            write_block(&mut writer, &name.val, block, version)?;
+        }
+        writeln!(writer, "}}")?;
+        Ok(())
+    }
+}
+
+/// Incremental [`BlockWriter`] for the .ldfree format. The output is the same as that of
+/// [`LdFreeFormatter`].
+pub struct LdFreeBlockWriter<W: Write> {
+    writer: W,
+    version: String,
+}
+
+impl<W: Write> LdFreeBlockWriter<W> {
+    pub fn new(mut writer: W, version: &str) -> Result<Self, Box<dyn Error>> {
+        writeln!(writer, "MEMORY\n{{")?;
+        Ok(Self {
+            writer,
+            version: version.to_string(),
+        })
+    }
+}
+
+impl<W: Write> BlockWriter for LdFreeBlockWriter<W> {
+    fn write_block(&mut self, block_name: &str, block: &Block) -> Result<(), Box<dyn Error>> {
+        write_block(&mut self.writer, block_name, block, &self.version)
+    }
+    fn needs_collapsed_blocks(&self) -> bool {
+        // Subregion symbols would otherwise be reported as free ranges in the parent block
+        true
+    }
+    fn finish(mut self: Box<Self>) -> Result<(), Box<dyn Error>> {
+        writeln!(self.writer, "}}")?;
+        self.writer.flush()?;
+        Ok(())
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn get_test_symgen() -> SymGen {
+        SymGen::read(
+            r"
+            main:
+              versions:
+                - v1
+                - v2
+              address:
+                v1: 0x2000000
+                v2: 0x2000000
+              length:
+                v1: 0x100000
+                v2: 0x100000
+              description: foo
+              functions:
+                - name: fn1
+                  address:
+                    v1: 0x2001000
+                    v2: 0x2000000
+                  length:
+                    v1: 0x1000
+                    v2: 0x1000
+                  description: bar
+                - name: fn2
+                  address:
+                    v1: 0x2002800
+                    v2: 0x2003000
+                  description: baz
+              data:
+                - name: SOME_DATA
+                  address:
+                    v1: 0x2003000
+                    v2: 0x2004000
+                  length:
+                    v1: 0x1000
+                    v2: 0x2000
+                  description: foo bar baz
+            other-block:
+              address: 0x2400000
+              length: 0x1000
+              functions: []
+              data: []
+        "
+            .as_bytes(),
+        )
+        .expect("Read failed")
+    }
+
+    #[test]
+    fn test_generate() {
+        let symgen = get_test_symgen();
+        let f = LdFreeFormatter {};
+        assert_eq!(
+            f.generate_str(&symgen, "v1").expect("generate failed"),
+            concat!(
+                "MEMORY\n{\n",
+                "  main_free_0 (rwx) : ORIGIN = 0x02000000, LENGTH = 0x1000\n",
+                "  main_free_1 (rwx) : ORIGIN = 0x02002000, LENGTH = 0x800\n",
+                "  main_free_2 (rwx) : ORIGIN = 0x02004000, LENGTH = 0xFC000\n",
+                "  other_block_free_0 (rwx) : ORIGIN = 0x02400000, LENGTH = 0x1000\n",
+                "}\n",
+            )
+        );
+        assert_eq!(
+            f.generate_str(&symgen, "v2").expect("generate failed"),
+            concat!(
+                "MEMORY\n{\n",
+                "  main_free_0 (rwx) : ORIGIN = 0x02001000, LENGTH = 0x2000\n",
+                "  main_free_1 (rwx) : ORIGIN = 0x02006000, LENGTH = 0xFA000\n",
+                "  other_block_free_0 (rwx) : ORIGIN = 0x02400000, LENGTH = 0x1000\n",
+                "}\n",
+            )
+        );
+    }
+
+    #[test]
+    fn test_generate_unknown_length_at_end() {
+        let symgen = SymGen::read(
+            r"
+            main:
+              address: 0x2000000
+              length: 0x1000
+              functions:
+                - name: fn1
+                  address: 0x2000000
+                  length: 0x10
+                - name: fn2
+                  address: 0x2000800
+              data: []
+            "
+            .as_bytes(),
+        )
+        .expect("Read failed");
+
+        let f = LdFreeFormatter {};
+        assert_eq!(
+            f.generate_str(&symgen, "").expect("generate failed"),
+            "MEMORY\n{\n  main_free_0 (rwx) : ORIGIN = 0x02000010, LENGTH = 0x7F0\n}\n"
+        );
+    }
+}
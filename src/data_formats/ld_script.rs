@@ -0,0 +1,201 @@
+//! A GNU ld linker script fragment defining symbol addresses (.ld).
+//!
+//! Each symbol (and each alias) is defined as an absolute address with a symbol assignment, so
+//! the fragment can be passed straight to the linker (e.g., with `-T`) to link code against the
+//! symbols in a binary. Names that aren't plain identifiers are quoted.
+//!
+//! Only functions and data are defined; blocks themselves don't get a symbol.
+//!
+//! A linker symbol can only have a single value, so each name is only defined once, at its first
+//! address. Any later occurrences of the same name within a version are listed in a comment
+//! instead. This applies to symbols with multiple addresses, but also to names that appear more
+//! than once in the symbol table, such as a symbol defined in more than one block, or an alias
+//! that matches another symbol's name. Functions are defined before data, so a function takes
+//! precedence over data with the same name.
+//!
+//! # Example
+//! ```text
+//! function1 = 0x02400000;
+//! function1_alias = 0x02400000;
+//! function2 = 0x02401000;
+//! /* function2 also at 0x02402000 */
+//! SOME_DATA = 0x02FFFFFF;
+//! ```
+
+use std::collections::HashSet;
+use std::error::Error;
+use std::io::Write;
+use std::iter;
+
+use super::symgen_yml::{Block, BlockWriter, Generate, RealizedSymbol, SymGen};
+
+/// Generator for the .ld format.
+pub struct LdScriptFormatter {}
+
+/// Returns whether `name` can be used in a linker script without quotes.
+fn is_plain_name(name: &str) -> bool {
+    let mut chars = name.chars();
+    matches!(chars.next(), Some(c) if c.is_ascii_alphabetic() || c == '_' || c == '.')
+        && chars.all(|c| c.is_ascii_alphanumeric() || c == '_' || c == '.')
+}
+
+/// Writes symbol assignments for `symbols` (and their aliases). `defined` tracks the names that
+/// have already been assigned.
+fn write_symbols<'s, W, I>(
+    mut writer: W,
+    symbols: I,
+    defined: &mut HashSet<String>,
+) -> Result<(), Box<dyn Error>>
+where
+    W: Write,
+    I: Iterator<Item = RealizedSymbol<'s>>,
+{
+    for s in symbols {
+        let aliases = s.aliases.unwrap_or(&[]).iter().map(|a| a.as_str());
+        for name in iter::once(s.name).chain(aliases) {
+            if defined.contains(name) {
+                writeln!(writer, "/* {} also at {:#010X} */", name, s.address)?;
+                continue;
+            }
+            defined.insert(name.to_string());
+            if is_plain_name(name) {
+                writeln!(writer, "{} = {:#010X};", name, s.address)?;
+            } else {
+                writeln!(writer, "\"{}\" = {:#010X};", name, s.address)?;
+            }
+        }
+    }
+    Ok(())
+}
+
+impl Generate for LdScriptFormatter {
+    fn generate<W: Write>(
+        &self,
+        mut writer: W,
+        symgen: &SymGen,
+        version: &str,
+    ) -> Result<(), Box<dyn Error>> {
+        let mut defined = HashSet::new();
+        write_symbols(
+            &mut writer,
+            symgen.functions_realized(version),
+            &mut defined,
+        )?;
+        write_symbols(&mut writer, symgen.data_realized(version), &mut defined)?;
+        Ok(())
+    }
+}
+
+/// Incremental [`BlockWriter`] for the .ld format.
+///
+/// Unlike [`LdScriptFormatter`], which lists all functions before all data, this lists the
+/// functions and then the data of each block in turn. The output is only the same for symbol
+/// tables with a single block.
+pub struct LdScriptBlockWriter<W: Write> {
+    writer: W,
+    version: String,
+    defined: HashSet<String>,
+}
+
+impl<W: Write> LdScriptBlockWriter<W> {
+    pub fn new(writer: W, version: &str) -> Self {
+        Self {
+            writer,
+            version: version.to_string(),
+            defined: HashSet::new(),
+        }
+    }
+}
+
+impl<W: Write> BlockWriter for LdScriptBlockWriter<W> {
+    fn write_block(&mut self, _block_name: &str, block: &Block) -> Result<(), Box<dyn Error>> {
+        write_symbols(
+            &mut self.writer,
+            block.functions_realized(&self.version),
+            &mut self.defined,
+        )?;
+        write_symbols(
+            &mut self.writer,
+            block.data_realized(&self.version),
+            &mut self.defined,
+        )
+    }
+    fn finish(mut self: Box<Self>) -> Result<(), Box<dyn Error>> {
+        self.writer.flush()?;
+        Ok(())
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn get_test_symgen() -> SymGen {
+        SymGen::read(
+            r"
+            main:
+              versions:
+                - v1
+                - v2
+              address:
+                v1: 0x2000000
+                v2: 0x2000000
+              length:
+                v1: 0x100000
+                v2: 0x100000
+              functions:
+                - name: fn1
+                  aliases:
+                    - fn1_alias
+                  address:
+                    v1: 0x2000000
+                    v2: 0x2002000
+                - name: fn2
+                  address:
+                    v1:
+                      - 0x2001000
+                      - 0x2002000
+                    v2: 0x2003000
+                - name: operator new
+                  address:
+                    v1: 0x2004000
+              data:
+                - name: SOME_DATA
+                  address:
+                    v1: 0x2003000
+                    v2: 0x2004000
+                  length:
+                    v1: 0x1000
+                    v2: 0x2000
+        "
+            .as_bytes(),
+        )
+        .expect("Read failed")
+    }
+
+    #[test]
+    fn test_generate() {
+        let symgen = get_test_symgen();
+        let f = LdScriptFormatter {};
+        assert_eq!(
+            f.generate_str(&symgen, "v1").expect("generate failed"),
+            concat!(
+                "fn1 = 0x02000000;\n",
+                "fn1_alias = 0x02000000;\n",
+                "fn2 = 0x02001000;\n",
+                "/* fn2 also at 0x02002000 */\n",
+                "\"operator new\" = 0x02004000;\n",
+                "SOME_DATA = 0x02003000;\n",
+            )
+        );
+        assert_eq!(
+            f.generate_str(&symgen, "v2").expect("generate failed"),
+            concat!(
+                "fn1 = 0x02002000;\n",
+                "fn1_alias = 0x02002000;\n",
+                "fn2 = 0x02003000;\n",
+                "SOME_DATA = 0x02004000;\n",
+            )
+        );
+    }
+}
@@ -14,10 +14,10 @@
 use std::error::Error;
 use std::io::Write;
 
-use csv::WriterBuilder;
+use csv::{Writer, WriterBuilder};
 use serde::{Serialize, Serializer};
 
-use super::symgen_yml::{Generate, SymGen, Uint};
+use super::symgen_yml::{Block, BlockWriter, Generate, RealizedSymbol, SymGen, Uint};
 
 /// Generator for the .sym format.
 pub struct SymFormatter {}
@@ -39,6 +39,29 @@ struct Entry<'a> {
     name: &'a str,
 }
 
+/// Writes `symbols` to `wtr`.
+fn write_symbols<'s, W, I>(wtr: &mut Writer<W>, symbols: I) -> Result<(), Box<dyn Error>>
+where
+    W: Write,
+    I: Iterator<Item = RealizedSymbol<'s>>,
+{
+    for s in symbols {
+        // NOTE: aliases are ignored here on purpose; only write the primary name
+        wtr.serialize(Entry {
+            address: s.address,
+            name: s.name,
+        })?;
+    }
+    Ok(())
+}
+
+fn csv_writer<W: Write>(writer: W) -> Writer<W> {
+    WriterBuilder::new()
+        .delimiter(b' ')
+        .has_headers(false)
+        .from_writer(writer)
+}
+
 impl Generate for SymFormatter {
     fn generate<W: Write>(
         &self,
@@ -46,17 +69,32 @@ impl Generate for SymFormatter {
         symgen: &SymGen,
         version: &str,
     ) -> Result<(), Box<dyn Error>> {
-        let mut wtr = WriterBuilder::new()
-            .delimiter(b' ')
-            .has_headers(false)
-            .from_writer(writer);
-        for s in symgen.symbols_realized(version) {
-            // NOTE: aliases are ignored here on purpose; only write the primary name
-            wtr.serialize(Entry {
-                address: s.address,
-                name: s.name,
-            })?;
+        write_symbols(&mut csv_writer(writer), symgen.symbols_realized(version))
+    }
+}
+
+/// Incremental [`BlockWriter`] for the .sym format. The output is the same as that of
+/// [`SymFormatter`].
+pub struct SymBlockWriter<W: Write> {
+    wtr: Writer<W>,
+    version: String,
+}
+
+impl<W: Write> SymBlockWriter<W> {
+    pub fn new(writer: W, version: &str) -> Self {
+        Self {
+            wtr: csv_writer(writer),
+            version: version.to_string(),
         }
+    }
+}
+
+impl<W: Write> BlockWriter for SymBlockWriter<W> {
+    fn write_block(&mut self, _block_name: &str, block: &Block) -> Result<(), Box<dyn Error>> {
+        write_symbols(&mut self.wtr, block.iter_realized(&self.version))
+    }
+    fn finish(mut self: Box<Self>) -> Result<(), Box<dyn Error>> {
+        self.wtr.flush()?;
         Ok(())
     }
 }
@@ -0,0 +1,456 @@
+//! A compact binary symbol index format (.symidx), designed to be memory-mapped and searched in
+//! place by consumers like tracers and crash symbolizers, without any parsing step.
+//!
+//! All integers are little-endian, and all offsets are byte offsets from the start of the file.
+//! The file consists of a header, a block table, one address-sorted symbol array per block, and a
+//! string pool. Symbols are always listed by their primary name; any aliases are ignored.
+//!
+//! The header is 24 bytes long:
+//!
+//! | Offset | Type      | Field                                    |
+//! |--------|-----------|------------------------------------------|
+//! | 0x0    | `[u8; 4]` | Magic number, `RSYM`                     |
+//! | 0x4    | `u32`     | Format version, currently 1              |
+//! | 0x8    | `u32`     | Number of blocks                         |
+//! | 0xC    | `u32`     | Offset of the block table                |
+//! | 0x10   | `u32`     | Offset of the string pool                |
+//! | 0x14   | `u32`     | Size of the string pool                  |
+//!
+//! The block table contains one 32-byte entry per block, in the same order as the blocks in the
+//! symbol table:
+//!
+//! | Offset | Type  | Field                                                |
+//! |--------|-------|------------------------------------------------------|
+//! | 0x0    | `u64` | Block address                                        |
+//! | 0x8    | `u64` | Block length                                         |
+//! | 0x10   | `u32` | Offset of the block name in the string pool          |
+//! | 0x14   | `u32` | Flags (bit 0: has address, bit 1: has length)        |
+//! | 0x18   | `u32` | Offset of the block's symbol array                   |
+//! | 0x1C   | `u32` | Number of symbols in the block's symbol array        |
+//!
+//! Each symbol array contains 24-byte entries sorted by address (then by type and name, to make
+//! the output deterministic), so an address can be looked up with a binary search:
+//!
+//! | Offset | Type  | Field                                                |
+//! |--------|-------|------------------------------------------------------|
+//! | 0x0    | `u64` | Symbol address                                       |
+//! | 0x8    | `u64` | Symbol length (0 if unknown)                         |
+//! | 0x10   | `u32` | Offset of the symbol name in the string pool         |
+//! | 0x14   | `u8`  | Symbol type (0: function, 1: data)                   |
+//! | 0x15   | `u8`  | Flags (bit 0: has length)                            |
+//! | 0x16   | `u16` | Reserved (0)                                         |
+//!
+//! The string pool contains deduplicated, NUL-terminated UTF-8 strings. Symbols that have
+//! multiple addresses within a version get one entry per address. All tables are 8-byte aligned
+//! relative to the start of the file.
+//!
+//! Blocks are kept separate because they can overlap (overlays in the same memory region are
+//! mutually exclusive); it's up to the consumer to pick the blocks that are actually loaded.
+
+use std::collections::HashMap;
+use std::convert::TryFrom;
+use std::error::Error;
+use std::io::Write;
+
+use super::symgen_yml::{Block, BlockWriter, Generate, SymGen, Uint};
+
+/// Generator for the .symidx format.
+pub struct SymIndexFormatter {}
+
+/// Magic number at the start of the file.
+pub const MAGIC: &[u8; 4] = b"RSYM";
+/// Format version written to the header.
+pub const FORMAT_VERSION: u32 = 1;
+
+const HEADER_SIZE: usize = 0x18;
+const BLOCK_ENTRY_SIZE: usize = 0x20;
+const SYMBOL_ENTRY_SIZE: usize = 0x18;
+
+const BLOCK_FLAG_HAS_ADDRESS: u32 = 1 << 0;
+const BLOCK_FLAG_HAS_LENGTH: u32 = 1 << 1;
+const SYMBOL_FLAG_HAS_LENGTH: u8 = 1 << 0;
+
+const SYMBOL_TYPE_FUNCTION: u8 = 0;
+const SYMBOL_TYPE_DATA: u8 = 1;
+
+/// A deduplicating pool of NUL-terminated strings.
+#[derive(Default)]
+struct StringPool {
+    data: Vec<u8>,
+    offsets: HashMap<String, u32>,
+}
+
+impl StringPool {
+    /// Adds `s` to the pool if it isn't already present, and returns its offset.
+    fn add(&mut self, s: &str) -> Result<u32, Box<dyn Error>> {
+        if let Some(&offset) = self.offsets.get(s) {
+            return Ok(offset);
+        }
+        let offset = u32::try_from(self.data.len())?;
+        self.data.extend_from_slice(s.as_bytes());
+        self.data.push(0);
+        self.offsets.insert(s.to_owned(), offset);
+        Ok(offset)
+    }
+}
+
+struct SymbolEntry {
+    address: Uint,
+    length: Option<Uint>,
+    name_offset: u32,
+    stype: u8,
+}
+
+struct BlockEntry {
+    address: Option<Uint>,
+    length: Option<Uint>,
+    name_offset: u32,
+    symbols: Vec<SymbolEntry>,
+}
+
+/// Accumulates the tables of a .symidx file, one block at a time.
+#[derive(Default)]
+struct IndexBuilder {
+    strings: StringPool,
+    blocks: Vec<BlockEntry>,
+}
+
+impl IndexBuilder {
+    /// Adds the symbols in `block` (named `block_name`) for the given version.
+    fn add_block(
+        &mut self,
+        block_name: &str,
+        block: &Block,
+        version: &str,
+    ) -> Result<(), Box<dyn Error>> {
+        let block_version = block.version(version);
+        let mut symbols = Vec::new();
+        for (stype, realized) in block
+            .functions_realized(version)
+            .map(|s| (SYMBOL_TYPE_FUNCTION, s))
+            .chain(block.data_realized(version).map(|s| (SYMBOL_TYPE_DATA, s)))
+        {
+            symbols.push((realized.address, stype, realized.name, realized.length));
+        }
+        symbols.sort_unstable();
+        let strings = &mut self.strings;
+        self.blocks.push(BlockEntry {
+            address: block.address.get(block_version).copied(),
+            length: block.length.get(block_version).copied(),
+            name_offset: strings.add(block_name)?,
+            symbols: symbols
+                .into_iter()
+                .map(|(address, stype, name, length)| {
+                    Ok(SymbolEntry {
+                        address,
+                        length,
+                        name_offset: strings.add(name)?,
+                        stype,
+                    })
+                })
+                .collect::<Result<_, Box<dyn Error>>>()?,
+        });
+        Ok(())
+    }
+
+    /// Lays out and writes the complete file to `writer`.
+    fn write<W: Write>(&self, mut writer: W) -> Result<(), Box<dyn Error>> {
+        let (strings, blocks) = (&self.strings, &self.blocks);
+
+        // Lay out the file. All entry sizes are multiples of 8, so everything stays aligned.
+        let mut symbols_offset = HEADER_SIZE + BLOCK_ENTRY_SIZE * blocks.len();
+        let strings_offset = symbols_offset
+            + SYMBOL_ENTRY_SIZE * blocks.iter().map(|b| b.symbols.len()).sum::<usize>();
+        let mut out = Vec::with_capacity(strings_offset + strings.data.len());
+
+        out.extend_from_slice(MAGIC);
+        out.extend_from_slice(&FORMAT_VERSION.to_le_bytes());
+        out.extend_from_slice(&u32::try_from(blocks.len())?.to_le_bytes());
+        out.extend_from_slice(&u32::try_from(HEADER_SIZE)?.to_le_bytes());
+        out.extend_from_slice(&u32::try_from(strings_offset)?.to_le_bytes());
+        out.extend_from_slice(&u32::try_from(strings.data.len())?.to_le_bytes());
+
+        for b in blocks.iter() {
+            let mut flags = 0;
+            if b.address.is_some() {
+                flags |= BLOCK_FLAG_HAS_ADDRESS;
+            }
+            if b.length.is_some() {
+                flags |= BLOCK_FLAG_HAS_LENGTH;
+            }
+            out.extend_from_slice(&b.address.unwrap_or(0).to_le_bytes());
+            out.extend_from_slice(&b.length.unwrap_or(0).to_le_bytes());
+            out.extend_from_slice(&b.name_offset.to_le_bytes());
+            out.extend_from_slice(&flags.to_le_bytes());
+            out.extend_from_slice(&u32::try_from(symbols_offset)?.to_le_bytes());
+            out.extend_from_slice(&u32::try_from(b.symbols.len())?.to_le_bytes());
+            symbols_offset += SYMBOL_ENTRY_SIZE * b.symbols.len();
+        }
+
+        for s in blocks.iter().flat_map(|b| b.symbols.iter()) {
+            let flags = if s.length.is_some() {
+                SYMBOL_FLAG_HAS_LENGTH
+            } else {
+                0
+            };
+            out.extend_from_slice(&s.address.to_le_bytes());
+            out.extend_from_slice(&s.length.unwrap_or(0).to_le_bytes());
+            out.extend_from_slice(&s.name_offset.to_le_bytes());
+            out.extend_from_slice(&[s.stype, flags, 0, 0]);
+        }
+
+        out.extend_from_slice(&strings.data);
+        writer.write_all(&out)?;
+        Ok(())
+    }
+}
+
+impl Generate for SymIndexFormatter {
+    fn generate<W: Write>(
+        &self,
+        writer: W,
+        symgen: &SymGen,
+        version: &str,
+    ) -> Result<(), Box<dyn Error>> {
+        let mut builder = IndexBuilder::default();
+        for (name, block) in symgen.iter() {
+            builder.add_block(&name.val, block, version)?;
+        }
+        builder.write(writer)
+    }
+}
+
+/// Incremental [`BlockWriter`] for the .symidx format. The output is the same as that of
+/// [`SymIndexFormatter`].
+///
+/// Since the header and block table come before the symbol arrays, nothing is written until
+/// [`BlockWriter::finish`] is called. In the meantime, only the fixed-size table entries and the
+/// string pool are kept in memory, rather than the blocks themselves.
+pub struct SymIndexBlockWriter<W: Write> {
+    writer: W,
+    version: String,
+    builder: IndexBuilder,
+}
+
+impl<W: Write> SymIndexBlockWriter<W> {
+    pub fn new(writer: W, version: &str) -> Self {
+        Self {
+            writer,
+            version: version.to_string(),
+            builder: IndexBuilder::default(),
+        }
+    }
+}
+
+impl<W: Write> BlockWriter for SymIndexBlockWriter<W> {
+    fn write_block(&mut self, block_name: &str, block: &Block) -> Result<(), Box<dyn Error>> {
+        self.builder.add_block(block_name, block, &self.version)
+    }
+    fn needs_collapsed_blocks(&self) -> bool {
+        // Each block's symbol arrays have to cover its whole address range
+        true
+    }
+    fn finish(mut self: Box<Self>) -> Result<(), Box<dyn Error>> {
+        self.builder.write(&mut self.writer)?;
+        self.writer.flush()?;
+        Ok(())
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::convert::TryInto;
+
+    fn get_test_symgen() -> SymGen {
+        SymGen::read(
+            r"
+            main:
+              versions:
+                - v1
+                - v2
+              address:
+                v1: 0x2000000
+                v2: 0x2000000
+              length:
+                v1: 0x100000
+                v2: 0x100004
+              description: foo
+              functions:
+                - name: fn1
+                  aliases:
+                    - fn1_alias
+                  address:
+                    v1: 0x2001000
+                    v2: 0x2002000
+                  length:
+                    v1: 0x1000
+                    v2: 0x1000
+                  description: bar
+                - name: fn2
+                  address:
+                    v1:
+                      - 0x2000000
+                      - 0x2003000
+                    v2: 0x2004000
+                  description: baz
+              data:
+                - name: SOME_DATA
+                  address:
+                    v1: 0x2002000
+                    v2: 0x2003000
+                  length:
+                    v1: 0x1000
+                    v2: 0x2000
+                  description: foo bar baz
+            other:
+              address: 0x2400000
+              length: 0x1000
+              functions:
+                - name: fn1
+                  address: 0x2400000
+              data: []
+        "
+            .as_bytes(),
+        )
+        .expect("Read failed")
+    }
+
+    fn u32_at(bytes: &[u8], offset: usize) -> u32 {
+        u32::from_le_bytes(bytes[offset..offset + 4].try_into().unwrap())
+    }
+
+    fn u64_at(bytes: &[u8], offset: usize) -> u64 {
+        u64::from_le_bytes(bytes[offset..offset + 8].try_into().unwrap())
+    }
+
+    fn str_at(bytes: &[u8], strings_offset: usize, offset: u32) -> &str {
+        let start = strings_offset + offset as usize;
+        let len = bytes[start..].iter().position(|&b| b == 0).unwrap();
+        std::str::from_utf8(&bytes[start..start + len]).unwrap()
+    }
+
+    /// Decoded block: (name, address, length, symbols), where each symbol is
+    /// (address, length, name, type).
+    type DecodedBlock<'a> = (
+        &'a str,
+        Option<u64>,
+        Option<u64>,
+        Vec<(u64, Option<u64>, &'a str, u8)>,
+    );
+
+    /// Decodes the file by reading it in place, the way a consumer would.
+    fn decode(bytes: &[u8]) -> Vec<DecodedBlock<'_>> {
+        assert_eq!(&bytes[..4], MAGIC);
+        assert_eq!(u32_at(bytes, 4), FORMAT_VERSION);
+        let n_blocks = u32_at(bytes, 8) as usize;
+        let blocks_offset = u32_at(bytes, 0xC) as usize;
+        let strings_offset = u32_at(bytes, 0x10) as usize;
+        assert_eq!(bytes.len(), strings_offset + u32_at(bytes, 0x14) as usize);
+        (0..n_blocks)
+            .map(|i| {
+                let b = blocks_offset + i * BLOCK_ENTRY_SIZE;
+                let flags = u32_at(bytes, b + 0x14);
+                let symbols_offset = u32_at(bytes, b + 0x18) as usize;
+                assert_eq!(symbols_offset % 8, 0);
+                let symbols = (0..u32_at(bytes, b + 0x1C) as usize)
+                    .map(|j| {
+                        let s = symbols_offset + j * SYMBOL_ENTRY_SIZE;
+                        let has_length = bytes[s + 0x15] & SYMBOL_FLAG_HAS_LENGTH != 0;
+                        (
+                            u64_at(bytes, s),
+                            Some(u64_at(bytes, s + 8)).filter(|_| has_length),
+                            str_at(bytes, strings_offset, u32_at(bytes, s + 0x10)),
+                            bytes[s + 0x14],
+                        )
+                    })
+                    .collect();
+                (
+                    str_at(bytes, strings_offset, u32_at(bytes, b + 0x10)),
+                    Some(u64_at(bytes, b)).filter(|_| flags & BLOCK_FLAG_HAS_ADDRESS != 0),
+                    Some(u64_at(bytes, b + 8)).filter(|_| flags & BLOCK_FLAG_HAS_LENGTH != 0),
+                    symbols,
+                )
+            })
+            .collect()
+    }
+
+    fn generate_bytes(symgen: &SymGen, version: &str) -> Vec<u8> {
+        let mut bytes = Vec::new();
+        SymIndexFormatter {}
+            .generate(&mut bytes, symgen, version)
+            .expect("generate failed");
+        bytes
+    }
+
+    #[test]
+    fn test_generate() {
+        let symgen = get_test_symgen();
+        let bytes = generate_bytes(&symgen, "v1");
+        assert_eq!(
+            decode(&bytes),
+            vec![
+                (
+                    "main",
+                    Some(0x2000000),
+                    Some(0x100000),
+                    vec![
+                        (0x2000000, None, "fn2", SYMBOL_TYPE_FUNCTION),
+                        (0x2001000, Some(0x1000), "fn1", SYMBOL_TYPE_FUNCTION),
+                        (0x2002000, Some(0x1000), "SOME_DATA", SYMBOL_TYPE_DATA),
+                        (0x2003000, None, "fn2", SYMBOL_TYPE_FUNCTION),
+                    ]
+                ),
+                (
+                    "other",
+                    Some(0x2400000),
+                    Some(0x1000),
+                    vec![(0x2400000, None, "fn1", SYMBOL_TYPE_FUNCTION)]
+                ),
+            ]
+        );
+        // Strings are deduplicated, and aliases are left out
+        let strings_offset = u32_at(&bytes, 0x10) as usize;
+        assert_eq!(
+            &bytes[strings_offset..],
+            b"main\0fn2\0fn1\0SOME_DATA\0other\0"
+        );
+
+        let bytes = generate_bytes(&symgen, "v2");
+        assert_eq!(
+            decode(&bytes)[0],
+            (
+                "main",
+                Some(0x2000000),
+                Some(0x100004),
+                vec![
+                    (0x2002000, Some(0x1000), "fn1", SYMBOL_TYPE_FUNCTION),
+                    (0x2003000, Some(0x2000), "SOME_DATA", SYMBOL_TYPE_DATA),
+                    (0x2004000, None, "fn2", SYMBOL_TYPE_FUNCTION),
+                ]
+            )
+        );
+    }
+
+    #[test]
+    fn test_generate_empty() {
+        let bytes = generate_bytes(&SymGen::read("{}".as_bytes()).expect("Read failed"), "");
+        assert_eq!(bytes.len(), HEADER_SIZE);
+        assert!(decode(&bytes).is_empty());
+    }
+
+    #[test]
+    fn test_binary_search() {
+        let symgen = get_test_symgen();
+        let bytes = generate_bytes(&symgen, "v1");
+        let symbols = &decode(&bytes)[0].3;
+        let lookup = |addr: u64| {
+            let i = symbols.partition_point(|s| s.0 <= addr);
+            i.checked_sub(1).map(|i| symbols[i].2)
+        };
+        assert_eq!(lookup(0x1FFFFFF), None);
+        assert_eq!(lookup(0x2001800), Some("fn1"));
+        assert_eq!(lookup(0x2002000), Some("SOME_DATA"));
+        assert_eq!(lookup(0x2FFFFFF), Some("fn2"));
+    }
+}
@@ -4,7 +4,7 @@
 use std::error::Error;
 use std::io::{Read, Write};
 
-use super::symgen::{SymGen, Symbol};
+use super::symgen::{Block, SymGen, Symbol};
 
 /// `Generate` implementers can convert a [`SymGen`] into a different data format.
 pub trait Generate {
@@ -24,6 +24,27 @@ pub trait Generate {
     }
 }
 
+/// `BlockWriter` implementers write a symbol table in some format for a single version
+/// incrementally, one [`Block`] at a time. This allows output to be generated without holding an
+/// entire [`SymGen`] in memory at once.
+///
+/// Unless otherwise noted by the format, the output for a sequence of [`Block`]s should be the
+/// same as the output of [`Generate`] for a [`SymGen`] containing those [`Block`]s.
+pub trait BlockWriter {
+    /// Write the contents of `block` (named `block_name`).
+    fn write_block(&mut self, block_name: &str, block: &Block) -> Result<(), Box<dyn Error>>;
+
+    /// Whether each [`Block`] passed to [`BlockWriter::write_block`] must already contain all the
+    /// symbols from its subregions. If not, the blocks within a subregion can be written through
+    /// separate calls, after their parent block.
+    fn needs_collapsed_blocks(&self) -> bool {
+        false
+    }
+
+    /// Write any trailing output and flush the underlying writer.
+    fn finish(self: Box<Self>) -> Result<(), Box<dyn Error>>;
+}
+
 /// Types of symbols within a [`SymGen`].
 #[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
 pub enum SymbolType {
@@ -650,6 +650,12 @@ where
 
 type BlockAssignment<'n, 'b> = (Option<PathBuf>, &'n String, &'b mut Block);
 
+/// Block extents computed during block inference, keyed by block identity so that each extent is
+/// only computed once over the course of a merge. The pointers are never dereferenced. Merging
+/// symbols only grows the symbol lists within blocks, so the blocks themselves (and thus their
+/// addresses and extents) stay fixed for the lifetime of the cache.
+type ExtentCache = HashMap<*const Block, MaybeVersionDep<(Uint, Option<Uint>)>>;
+
 impl SymGen {
     /// Merges `other` into `self`.
     pub fn merge_symgen(&mut self, other: &Self) -> Result<(), MergeError> {
@@ -663,6 +669,7 @@ impl SymGen {
         &'b mut self,
         to_add: &'s AddSymbol,
         subregion_path: Option<&Path>,
+        extents: &mut ExtentCache,
     ) -> Result<Option<BlockAssignment<'n, 'b>>, MergeError>
     where
         'b: 'n,
@@ -685,7 +692,10 @@ impl SymGen {
             // In subregion or no block name, so try to infer the block based on the symbol address
             let mut block_matches: BlockMatches<InferBlockMatch<_>> = BlockMatches::None;
             for (bname, block) in self.iter_mut() {
-                if bounds::block_contains_symbol(block, &to_add.symbol) {
+                let extent = extents
+                    .entry(block as *const Block)
+                    .or_insert_with(|| block.extent());
+                if bounds::symbol_in_bounds(extent, &to_add.symbol, &block.versions).is_none() {
                     block_matches.add((subregion_path, &bname.val, block));
                 }
             }
@@ -708,7 +718,9 @@ impl SymGen {
                     } else {
                         Cow::Borrowed(&subregion.name)
                     };
-                    if let Some(assignment) = symgen.assign_block(to_add, Some(&sub_path))? {
+                    if let Some(assignment) =
+                        symgen.assign_block(to_add, Some(&sub_path), extents)?
+                    {
                         block_matches.add(assignment);
                     }
                 }
@@ -756,8 +768,9 @@ impl SymGen {
     {
         let mut unmerged_symbols = Vec::new();
         let mut sym_manager = SymbolManager::new();
+        let mut extents = ExtentCache::new();
         for to_add in other {
-            let assignment = self.assign_block(&to_add, None)?;
+            let assignment = self.assign_block(&to_add, None, &mut extents)?;
             let (sub_path, bname, block) = match assignment {
                 Some((sub_path, bname, block)) => (sub_path, bname, block),
                 None => {
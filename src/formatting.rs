@@ -9,8 +9,9 @@ use std::path::Path;
 use similar::TextDiff;
 use termcolor::{Color, ColorChoice, ColorSpec, StandardStream, WriteColor};
 
+use super::cache::{self, ResultCache};
 use super::data_formats::symgen_yml::{IntFormat, Sort, Subregion, SymGen};
-use super::util;
+use super::util::{self, MultiFileError};
 
 /// Formats a given `input_file` using the given `int_format`.
 ///
@@ -80,6 +81,84 @@ pub fn format_check_file<P: AsRef<Path>>(
     Ok(success)
 }
 
+/// Checks the format of each of the given `input_files`, subject to the given `int_format`.
+///
+/// In `recursive` mode, subregion files are also checked.
+///
+/// If a `cache_file` is given, files that pass the check are recorded there, and are skipped in
+/// later runs for as long as they (and their subregion files in `recursive` mode) are unchanged.
+///
+/// Returns `true` if all files are formatted correctly. Otherwise, returns `false` and prints a
+/// diff for each file that isn't.
+///
+/// # Examples
+/// ```ignore
+/// let succeeded = format_check_files(
+///     ["/path/to/symbols.yml", "/path/to/other_symbols.yml"],
+///     true,
+///     IntFormat::Hexadecimal,
+///     Some(Path::new("target/resymgen-cache/fmt.json")),
+/// )
+/// .expect("Format check failed");
+/// ```
+pub fn format_check_files<I, P>(
+    input_files: I,
+    recursive: bool,
+    int_format: IntFormat,
+    cache_file: Option<&Path>,
+) -> Result<bool, Box<dyn Error>>
+where
+    P: AsRef<Path>,
+    I: AsRef<[P]>,
+{
+    let input_files = input_files.as_ref();
+    let config = format!(
+        "fmt {}",
+        match int_format {
+            IntFormat::Decimal => "decimal",
+            IntFormat::Hexadecimal => "hexadecimal",
+        }
+    );
+    let mut cache: Option<ResultCache<bool>> = cache_file.map(ResultCache::load);
+    let mut errors = Vec::with_capacity(input_files.len());
+    let mut success = true;
+    for input_file in input_files {
+        let input_file = input_file.as_ref();
+        let key = match &cache {
+            Some(_) => cache::content_key(input_file, recursive, &config).ok(),
+            None => None,
+        };
+        if let (Some(cache), Some(key)) = (&cache, &key) {
+            if cache.get(input_file, key) == Some(&true) {
+                continue;
+            }
+        }
+        match format_check_file(input_file, recursive, int_format) {
+            Ok(true) => {
+                if let (Some(cache), Some(key)) = (cache.as_mut(), key) {
+                    cache.insert(input_file, key, true);
+                }
+            }
+            Ok(false) => {
+                println!();
+                success = false;
+            }
+            Err(e) => errors.push((input_file.to_string_lossy().into_owned(), e)),
+        }
+    }
+    if let Some(cache) = cache.as_mut() {
+        cache.save()?;
+    }
+    if !errors.is_empty() {
+        return Err(MultiFileError {
+            base_msg: "Could not complete format check".to_string(),
+            errors,
+        }
+        .into());
+    }
+    Ok(success)
+}
+
 /// Prints a diff between a file and its formatted version in unified diff format.
 /// The title is printed as part of the diff header.
 fn print_format_diff<D: Display>(old: &str, new: &str, title: D) -> io::Result<()> {
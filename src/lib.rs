@@ -11,9 +11,11 @@
 //! The [`data_formats`] module defines structures and methods related to parsing and manipulating
 //! raw symbol data in various formats.
 
+mod cache;
 mod checks;
 pub mod data_formats;
 mod formatting;
+mod lookup;
 mod transform;
 mod util;
 
@@ -21,5 +23,6 @@ pub use checks::*;
 pub use data_formats::symgen_yml::{IntFormat, LoadParams, SymbolType};
 pub use data_formats::{InFormat, OutFormat};
 pub use formatting::*;
+pub use lookup::*;
 pub use transform::*;
 pub use util::*;
@@ -0,0 +1,651 @@
+//! Address and name lookups within `resymgen` YAML symbol tables. Used by the `lookup` command.
+//!
+//! A [`SymbolIndex`] is built once from a [`SymGen`], after which any number of queries can be
+//! answered without rescanning the symbol table. Address queries use a per-version interval index
+//! over blocks and symbols, and name queries (which also match aliases) use a hash map.
+
+use std::collections::HashMap;
+use std::error::Error;
+use std::io::{BufRead, Write};
+
+use super::data_formats::symgen_yml::{IntFormat, Realize, SymGen, SymbolType, Uint};
+
+/// A sorted list of half-open intervals, which supports finding all the intervals containing a
+/// given point, even if the intervals overlap.
+#[derive(Debug, Default)]
+struct IntervalIndex {
+    /// (start, end, id), sorted by start.
+    intervals: Vec<(Uint, Uint, usize)>,
+    /// max_end[i] is the maximum end of intervals[..=i].
+    max_end: Vec<Uint>,
+}
+
+impl IntervalIndex {
+    fn new(mut intervals: Vec<(Uint, Uint, usize)>) -> Self {
+        intervals.sort_unstable();
+        let max_end = intervals
+            .iter()
+            .scan(0, |max, &(_, end, _)| {
+                *max = end.max(*max);
+                Some(*max)
+            })
+            .collect();
+        Self { intervals, max_end }
+    }
+
+    /// Returns the intervals containing `point`, in descending order by start (so nested
+    /// intervals come before the intervals containing them).
+    fn containing(&self, point: Uint) -> impl Iterator<Item = &(Uint, Uint, usize)> + '_ {
+        let n = self
+            .intervals
+            .partition_point(|&(start, _, _)| start <= point);
+        // Walk backwards until no earlier interval can reach the point.
+        (0..n)
+            .rev()
+            .take_while(move |&i| self.max_end[i] > point)
+            .map(move |i| &self.intervals[i])
+            .filter(move |&&(_, end, _)| end > point)
+    }
+}
+
+/// A symbol within a [`SymbolIndex`].
+#[derive(Debug, PartialEq, Eq)]
+pub struct IndexedSymbol {
+    /// The primary name of the symbol.
+    pub name: String,
+    /// Any alternative names of the symbol.
+    pub aliases: Vec<String>,
+    /// Whether the symbol is a function or data.
+    pub symbol_type: SymbolType,
+    block: usize,
+    /// For each version, the realized (address, length) pairs.
+    extents: Vec<Vec<(Uint, Option<Uint>)>>,
+}
+
+#[derive(Debug)]
+struct IndexedBlock {
+    name: String,
+    /// For each version, the block extent, if the block has an address and length.
+    extents: Vec<Option<(Uint, Uint)>>,
+}
+
+#[derive(Debug, Clone, Copy)]
+enum NameTarget {
+    Block(usize),
+    Symbol(usize),
+}
+
+/// A block or symbol that contains a queried address.
+#[derive(Debug, PartialEq, Eq)]
+pub struct AddressMatch<'a> {
+    /// The name of the containing block.
+    pub block: &'a str,
+    /// The containing symbol, or `None` if the address isn't covered by any symbol in the block.
+    pub symbol: Option<&'a IndexedSymbol>,
+    /// The offset of the address from the start of the symbol (or block, if there's no symbol).
+    pub offset: Uint,
+}
+
+/// A block or symbol whose name (or alias) matches a queried name.
+#[derive(Debug, PartialEq, Eq)]
+pub struct NameMatch<'a> {
+    /// The name of the matching block, or of the block containing the matching symbol.
+    pub block: &'a str,
+    /// The matching symbol, or `None` if the query matched the block itself.
+    pub symbol: Option<&'a IndexedSymbol>,
+    /// The address of the match.
+    pub address: Uint,
+    /// The length of the match, if known.
+    pub length: Option<Uint>,
+}
+
+/// An index for looking up blocks and symbols by address or by name, for a fixed set of versions.
+#[derive(Debug)]
+pub struct SymbolIndex {
+    versions: Vec<String>,
+    blocks: Vec<IndexedBlock>,
+    symbols: Vec<IndexedSymbol>,
+    /// For each version, an interval index over block extents.
+    block_intervals: Vec<IntervalIndex>,
+    /// For each version, an interval index over symbol extents.
+    symbol_intervals: Vec<IntervalIndex>,
+    names: HashMap<String, Vec<NameTarget>>,
+}
+
+impl SymbolIndex {
+    /// Builds a [`SymbolIndex`] over the contents of `symgen` for each of the given `versions`.
+    ///
+    /// Subregions should already be resolved and collapsed for their contents to be indexed.
+    /// Symbols without an explicit length are assumed to extend up to the next symbol in the
+    /// same block (or the end of the block).
+    pub fn new<S: AsRef<str>>(symgen: &SymGen, versions: &[S]) -> Self {
+        let mut index = Self {
+            versions: versions.iter().map(|v| v.as_ref().to_string()).collect(),
+            blocks: Vec::new(),
+            symbols: Vec::new(),
+            block_intervals: Vec::with_capacity(versions.len()),
+            symbol_intervals: Vec::with_capacity(versions.len()),
+            names: HashMap::new(),
+        };
+        for (name, block) in symgen.iter() {
+            let block_id = index.blocks.len();
+            index.blocks.push(IndexedBlock {
+                name: name.val.clone(),
+                extents: index
+                    .versions
+                    .iter()
+                    .map(|v| {
+                        let version = block.version(v);
+                        match (block.address.get(version), block.length.get(version)) {
+                            (Some(&addr), Some(&len)) => Some((addr, len)),
+                            _ => None,
+                        }
+                    })
+                    .collect(),
+            });
+            index.add_name(&name.val, NameTarget::Block(block_id));
+            let typed_symbols = block
+                .functions
+                .iter()
+                .map(|s| (SymbolType::Function, s))
+                .chain(block.data.iter().map(|s| (SymbolType::Data, s)));
+            for (symbol_type, symbol) in typed_symbols {
+                let symbol_id = index.symbols.len();
+                index.add_name(&symbol.name, NameTarget::Symbol(symbol_id));
+                for alias in symbol.aliases.iter().flatten() {
+                    index.add_name(alias, NameTarget::Symbol(symbol_id));
+                }
+                index.symbols.push(IndexedSymbol {
+                    name: symbol.name.clone(),
+                    aliases: symbol.aliases.clone().unwrap_or_default(),
+                    symbol_type,
+                    block: block_id,
+                    extents: index
+                        .versions
+                        .iter()
+                        .map(|v| {
+                            std::iter::once(symbol)
+                                .realize(block.version(v))
+                                .map(|s| (s.address, s.length))
+                                .collect()
+                        })
+                        .collect(),
+                });
+            }
+        }
+
+        for v in 0..index.versions.len() {
+            index.block_intervals.push(IntervalIndex::new(
+                index
+                    .blocks
+                    .iter()
+                    .enumerate()
+                    .filter_map(|(i, b)| b.extents[v].map(|(a, l)| (a, a.saturating_add(l), i)))
+                    .collect(),
+            ));
+            index.symbol_intervals.push(index.symbol_intervals_for(v));
+        }
+        index
+    }
+
+    fn add_name(&mut self, name: &str, target: NameTarget) {
+        self.names.entry(name.to_string()).or_default().push(target);
+    }
+
+    /// Computes symbol intervals for the version with index `v`.
+    fn symbol_intervals_for(&self, v: usize) -> IntervalIndex {
+        // (address, length, symbol id) for each block
+        let mut by_block = vec![Vec::new(); self.blocks.len()];
+        for (i, s) in self.symbols.iter().enumerate() {
+            for &(addr, len) in s.extents[v].iter() {
+                by_block[s.block].push((addr, len, i));
+            }
+        }
+        let mut intervals = Vec::new();
+        for (block, mut symbols) in self.blocks.iter().zip(by_block) {
+            let block_end = block.extents[v].map(|(a, l)| a.saturating_add(l));
+            symbols.sort_unstable();
+            for (j, &(addr, len, i)) in symbols.iter().enumerate() {
+                let end = match len {
+                    Some(len) => addr.saturating_add(len),
+                    None => symbols[j + 1..]
+                        .iter()
+                        .map(|&(a, _, _)| a)
+                        .find(|&a| a > addr)
+                        .or(block_end)
+                        .unwrap_or_else(|| addr.saturating_add(1)),
+                };
+                intervals.push((addr, end, i));
+            }
+        }
+        IntervalIndex::new(intervals)
+    }
+
+    /// Returns the versions covered by the index.
+    pub fn versions(&self) -> impl Iterator<Item = &str> {
+        self.versions.iter().map(|v| v.as_ref())
+    }
+
+    fn version_id(&self, version: &str) -> Option<usize> {
+        self.versions.iter().position(|v| v == version)
+    }
+
+    /// Finds the blocks and symbols containing `address` in the given `version`.
+    ///
+    /// For every block containing the address, the symbols containing the address are returned,
+    /// with nested symbols before the symbols containing them. If none of the symbols in a
+    /// block contain the address, a match with only the block is returned. Symbols that aren't
+    /// within any block extent are returned last.
+    pub fn lookup_address(&self, version: &str, address: Uint) -> Vec<AddressMatch<'_>> {
+        let v = match self.version_id(version) {
+            Some(v) => v,
+            None => return Vec::new(),
+        };
+        let mut symbols: Vec<_> = self.symbol_intervals[v].containing(address).collect();
+        let mut matches = Vec::new();
+        for &(start, _, block_id) in self.block_intervals[v].containing(address) {
+            let n_matches = matches.len();
+            symbols.retain(|&&(sym_start, _, i)| {
+                let s = &self.symbols[i];
+                if s.block != block_id {
+                    return true;
+                }
+                matches.push(AddressMatch {
+                    block: &self.blocks[block_id].name,
+                    symbol: Some(s),
+                    offset: address - sym_start,
+                });
+                false
+            });
+            if matches.len() == n_matches {
+                matches.push(AddressMatch {
+                    block: &self.blocks[block_id].name,
+                    symbol: None,
+                    offset: address - start,
+                });
+            }
+        }
+        matches.extend(symbols.into_iter().map(|&(start, _, i)| {
+            let s = &self.symbols[i];
+            AddressMatch {
+                block: &self.blocks[s.block].name,
+                symbol: Some(s),
+                offset: address - start,
+            }
+        }));
+        matches
+    }
+
+    /// Finds the blocks and symbols with the given `name` (including aliases) in the given
+    /// `version`. Symbols with multiple addresses get one match per address.
+    pub fn lookup_name(&self, version: &str, name: &str) -> Vec<NameMatch<'_>> {
+        let (v, targets) = match (self.version_id(version), self.names.get(name)) {
+            (Some(v), Some(targets)) => (v, targets),
+            _ => return Vec::new(),
+        };
+        let mut matches = Vec::new();
+        for &target in targets {
+            match target {
+                NameTarget::Block(i) => {
+                    let b = &self.blocks[i];
+                    if let Some((address, length)) = b.extents[v] {
+                        matches.push(NameMatch {
+                            block: &b.name,
+                            symbol: None,
+                            address,
+                            length: Some(length),
+                        });
+                    }
+                }
+                NameTarget::Symbol(i) => {
+                    let s = &self.symbols[i];
+                    matches.extend(s.extents[v].iter().map(|&(address, length)| NameMatch {
+                        block: &self.blocks[s.block].name,
+                        symbol: Some(s),
+                        address,
+                        length,
+                    }));
+                }
+            }
+        }
+        matches
+    }
+
+    /// Answers a single query for the given `version`, writing results to `output`.
+    ///
+    /// Queries starting with a digit are parsed as addresses (hexadecimal if prefixed with "0x",
+    /// and in the `bare_format` otherwise); all other queries are treated as names. Each result is
+    /// written on its own line as tab-separated fields, starting with the query and version:
+    /// - address results: `<query> <version> <block> <symbol>+<offset>` (or `<block>+<offset>`
+    ///   if the address isn't covered by a symbol)
+    /// - name results: `<query> <version> <block> <address> <length>` (with `?` for an unknown
+    ///   length)
+    ///
+    /// If there are no results, a single line is written with `?` in place of the block. If the
+    /// query is an invalid address, a single line `<query> <version> !<error>` is written instead,
+    /// and `false` is returned.
+    pub fn answer_query<W: Write>(
+        &self,
+        mut output: W,
+        version: &str,
+        query: &str,
+        bare_format: IntFormat,
+    ) -> Result<bool, Box<dyn Error>> {
+        let mut found = false;
+        if query.starts_with(|c: char| c.is_ascii_digit()) {
+            let address = match (
+                query
+                    .strip_prefix("0x")
+                    .or_else(|| query.strip_prefix("0X")),
+                bare_format,
+            ) {
+                (Some(hex), _) => Uint::from_str_radix(hex, 16),
+                (None, IntFormat::Hexadecimal) => Uint::from_str_radix(query, 16),
+                (None, IntFormat::Decimal) => query.parse(),
+            };
+            let address = match address {
+                Ok(a) => a,
+                Err(e) => {
+                    writeln!(output, "{}\t{}\t!invalid address: {}", query, version, e)?;
+                    return Ok(false);
+                }
+            };
+            for m in self.lookup_address(version, address) {
+                let name = m.symbol.map_or(m.block, |s| &s.name);
+                writeln!(
+                    output,
+                    "{}\t{}\t{}\t{}+{:#X}",
+                    query, version, m.block, name, m.offset
+                )?;
+                found = true;
+            }
+        } else {
+            for m in self.lookup_name(version, query) {
+                write!(
+                    output,
+                    "{}\t{}\t{}\t{:#X}\t",
+                    query, version, m.block, m.address
+                )?;
+                match m.length {
+                    Some(len) => writeln!(output, "{:#X}", len)?,
+                    None => writeln!(output, "?")?,
+                }
+                found = true;
+            }
+        }
+        if !found {
+            writeln!(output, "{}\t{}\t?", query, version)?;
+        }
+        Ok(true)
+    }
+
+    /// Answers newline-separated queries read from `input` for all versions in the index,
+    /// writing results to `output`. Blank lines are ignored. See [`SymbolIndex::answer_query`].
+    ///
+    /// Invalid queries don't stop the batch. Their error lines are written in place of results,
+    /// and once all the queries have been answered, an error with the number of invalid query
+    /// lines is returned.
+    pub fn answer_queries<R: BufRead, W: Write>(
+        &self,
+        input: R,
+        mut output: W,
+        bare_format: IntFormat,
+    ) -> Result<(), Box<dyn Error>> {
+        let mut n_invalid = 0;
+        for line in input.lines() {
+            let line = line?;
+            let query = line.trim();
+            if query.is_empty() {
+                continue;
+            }
+            let mut valid = true;
+            for version in self.versions.iter() {
+                valid &= self.answer_query(&mut output, version, query, bare_format)?;
+            }
+            if !valid {
+                n_invalid += 1;
+            }
+        }
+        output.flush()?;
+        if n_invalid > 0 {
+            return Err(format!("Invalid address in {} query line(s)", n_invalid).into());
+        }
+        Ok(())
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn get_test_symgen() -> SymGen {
+        SymGen::read(
+            r"
+            main:
+              versions:
+                - v1
+                - v2
+              address:
+                v1: 0x2000000
+                v2: 0x2000000
+              length:
+                v1: 0x10000
+                v2: 0x10000
+              functions:
+                - name: fn1
+                  aliases:
+                    - fn1_alias
+                  address:
+                    v1: 0x2001000
+                    v2: 0x2002000
+                  length:
+                    v1: 0x1000
+                    v2: 0x1000
+                - name: fn2
+                  address:
+                    v1:
+                      - 0x2003000
+                      - 0x2005000
+              data:
+                - name: SOME_DATA
+                  address:
+                    v1: 0x2001800
+                    v2: 0x2002800
+                  length:
+                    v1: 0x10
+                    v2: 0x10
+            overlay:
+              versions:
+                - v1
+                - v2
+              address:
+                v1: 0x2004000
+                v2: 0x2004000
+              length:
+                v1: 0x100
+                v2: 0x100
+              functions:
+                - name: fn3
+                  address:
+                    v1: 0x2004000
+                    v2: 0x2004000
+                  length:
+                    v1: 0x10
+                    v2: 0x10
+              data: []
+            "
+            .as_bytes(),
+        )
+        .expect("Read failed")
+    }
+
+    fn address_matches(index: &SymbolIndex, version: &str, address: Uint) -> Vec<String> {
+        index
+            .lookup_address(version, address)
+            .into_iter()
+            .map(|m| match m.symbol {
+                Some(s) => format!("{}:{}+{:#X}", m.block, s.name, m.offset),
+                None => format!("{}+{:#X}", m.block, m.offset),
+            })
+            .collect()
+    }
+
+    #[test]
+    fn test_interval_index() {
+        let index = IntervalIndex::new(vec![(0, 10, 0), (2, 4, 1), (5, 6, 2), (7, 20, 3)]);
+        let ids = |p| index.containing(p).map(|&(_, _, i)| i).collect::<Vec<_>>();
+        assert_eq!(ids(0), vec![0]);
+        assert_eq!(ids(3), vec![1, 0]);
+        assert_eq!(ids(4), vec![0]);
+        assert_eq!(ids(8), vec![3, 0]);
+        assert_eq!(ids(15), vec![3]);
+        assert_eq!(ids(20), Vec::<usize>::new());
+    }
+
+    #[test]
+    fn test_lookup_address() {
+        let index = SymbolIndex::new(&get_test_symgen(), &["v1", "v2"]);
+        assert_eq!(
+            address_matches(&index, "v1", 0x1FFFFFF),
+            Vec::<String>::new()
+        );
+        assert_eq!(address_matches(&index, "v1", 0x2000010), vec!["main+0x10"]);
+        assert_eq!(
+            address_matches(&index, "v1", 0x2001804),
+            vec!["main:SOME_DATA+0x4", "main:fn1+0x804"]
+        );
+        assert_eq!(
+            address_matches(&index, "v2", 0x2001804),
+            vec!["main+0x1804"]
+        );
+        // fn2 has no length, so it extends to the end of the block
+        assert_eq!(
+            address_matches(&index, "v1", 0x2004004),
+            vec!["overlay:fn3+0x4", "main:fn2+0x1004"]
+        );
+        assert_eq!(
+            address_matches(&index, "v1", 0x2004800),
+            vec!["main:fn2+0x1800"]
+        );
+        assert_eq!(
+            address_matches(&index, "v1", 0x2005000),
+            vec!["main:fn2+0x0"]
+        );
+        assert_eq!(
+            address_matches(&index, "v3", 0x2001000),
+            Vec::<String>::new()
+        );
+    }
+
+    #[test]
+    fn test_lookup_name() {
+        let index = SymbolIndex::new(&get_test_symgen(), &["v1", "v2"]);
+        let matches = |version, name| {
+            index
+                .lookup_name(version, name)
+                .into_iter()
+                .map(|m| {
+                    (
+                        m.block,
+                        m.symbol.map(|s| s.name.as_str()),
+                        m.address,
+                        m.length,
+                    )
+                })
+                .collect::<Vec<_>>()
+        };
+        assert_eq!(
+            matches("v1", "fn1"),
+            vec![("main", Some("fn1"), 0x2001000, Some(0x1000))]
+        );
+        assert_eq!(
+            matches("v2", "fn1_alias"),
+            vec![("main", Some("fn1"), 0x2002000, Some(0x1000))]
+        );
+        assert_eq!(
+            matches("v1", "fn2"),
+            vec![
+                ("main", Some("fn2"), 0x2003000, None),
+                ("main", Some("fn2"), 0x2005000, None)
+            ]
+        );
+        assert_eq!(matches("v2", "fn2"), vec![]);
+        assert_eq!(
+            matches("v2", "overlay"),
+            vec![("overlay", None, 0x2004000, Some(0x100))]
+        );
+        assert_eq!(matches("v1", "nonexistent"), vec![]);
+    }
+
+    #[test]
+    fn test_answer_queries() {
+        let index = SymbolIndex::new(&get_test_symgen(), &["v1", "v2"]);
+        let mut output = Vec::new();
+        index
+            .answer_queries(
+                "0x2001000\n\nfn2\n33558528\n".as_bytes(),
+                &mut output,
+                IntFormat::Decimal,
+            )
+            .expect("answer_queries failed");
+        assert_eq!(
+            String::from_utf8(output).unwrap(),
+            concat!(
+                "0x2001000\tv1\tmain\tfn1+0x0\n",
+                "0x2001000\tv2\tmain\tmain+0x1000\n",
+                "fn2\tv1\tmain\t0x2003000\t?\n",
+                "fn2\tv1\tmain\t0x2005000\t?\n",
+                "fn2\tv2\t?\n",
+                "33558528\tv1\tmain\tfn1+0x0\n",
+                "33558528\tv2\tmain\tmain+0x1000\n",
+            )
+        );
+    }
+
+    #[test]
+    fn test_answer_queries_hex() {
+        let index = SymbolIndex::new(&get_test_symgen(), &["v1"]);
+        let mut output = Vec::new();
+        index
+            .answer_queries(
+                "2001000\n0x2004000\n".as_bytes(),
+                &mut output,
+                IntFormat::Hexadecimal,
+            )
+            .expect("answer_queries failed");
+        assert_eq!(
+            String::from_utf8(output).unwrap(),
+            concat!(
+                "2001000\tv1\tmain\tfn1+0x0\n",
+                "0x2004000\tv1\toverlay\tfn3+0x0\n",
+                "0x2004000\tv1\tmain\tfn2+0x1000\n",
+            )
+        );
+    }
+
+    #[test]
+    fn test_answer_queries_invalid() {
+        let index = SymbolIndex::new(&get_test_symgen(), &["v1", "v2"]);
+        let mut output = Vec::new();
+        let err = index
+            .answer_queries(
+                "0xZZZ\n0x2001000\n12ab\n".as_bytes(),
+                &mut output,
+                IntFormat::Decimal,
+            )
+            .expect_err("answer_queries succeeded");
+        assert_eq!(err.to_string(), "Invalid address in 2 query line(s)");
+        // Invalid queries get error lines, and the queries after them are still answered
+        assert_eq!(
+            String::from_utf8(output).unwrap(),
+            concat!(
+                "0xZZZ\tv1\t!invalid address: invalid digit found in string\n",
+                "0xZZZ\tv2\t!invalid address: invalid digit found in string\n",
+                "0x2001000\tv1\tmain\tfn1+0x0\n",
+                "0x2001000\tv2\tmain\tmain+0x1000\n",
+                "12ab\tv1\t!invalid address: invalid digit found in string\n",
+                "12ab\tv2\t!invalid address: invalid digit found in string\n",
+            )
+        );
+    }
+}
@@ -75,7 +75,7 @@ fn run_resymgen() -> Result<(), Box<dyn Error>> {
                 .about("Generates one or more symbol tables from a resymgen YAML file and its subregion files")
                 .args(&[
                     Arg::with_name("format")
-                        .help("Symbol table output format")
+                        .help("Symbol table output format (default: ghidra, sym, and json)")
                         .takes_value(true)
                         .short("f")
                         .long("format")
@@ -93,6 +93,15 @@ fn run_resymgen() -> Result<(), Box<dyn Error>> {
                         .help("Within each symbol category (functions, data), generate symbols in order by address")
                         .short("s")
                         .long("sort"),
+                    Arg::with_name("jobs")
+                        .help("Number of symbol tables (formats and versions) to generate concurrently for each input file (ignored with --stream)")
+                        .takes_value(true)
+                        .short("j")
+                        .long("jobs")
+                        .default_value("1"),
+                    Arg::with_name("stream")
+                        .help("Load and write one subregion file at a time to reduce memory usage (function and data symbols in the text formats are grouped by file; with the ldfree or symidx formats, each top-level block is still loaded with all its subregions)")
+                        .long("stream"),
                     Arg::with_name("output directory")
                         .help("Output directory")
                         .takes_value(true)
@@ -123,6 +132,12 @@ fn run_resymgen() -> Result<(), Box<dyn Error>> {
                         .help("Write integers in decimal format. By default integers are written as hexadecimal.")
                         .short("d")
                         .long("decimal"),
+                    Arg::with_name("cache")
+                        .help("Directory in which to cache format check results between runs (only used in 'check' mode). Files that passed the check and haven't changed since (including subregion files, with --recursive) aren't checked again.")
+                        .takes_value(true)
+                        .long("cache")
+                        .value_name("DIR")
+                        .requires("check"),
                     Arg::with_name("input")
                         .help("Input resymgen YAML file name(s)")
                         .required(true)
@@ -180,6 +195,17 @@ fn run_resymgen() -> Result<(), Box<dyn Error>> {
                         .number_of_values(1)
                         .set(ArgSettings::CaseInsensitive)
                         .possible_values(&SUPPORTED_NAMING_CONVENTIONS),
+                    Arg::with_name("jobs")
+                        .help("Number of input files to validate concurrently")
+                        .takes_value(true)
+                        .short("j")
+                        .long("jobs")
+                        .default_value("1"),
+                    Arg::with_name("cache")
+                        .help("Directory in which to cache check results between runs. Files that haven't changed since their results were cached (including subregion files, with --recursive) aren't checked again.")
+                        .takes_value(true)
+                        .long("cache")
+                        .value_name("DIR"),
                     Arg::with_name("input")
                         .help("Input resymgen YAML file name(s)")
                         .required(true)
@@ -187,6 +213,36 @@ fn run_resymgen() -> Result<(), Box<dyn Error>> {
                         .index(1),
                 ]),
         )
+        .subcommand(
+            SubCommand::with_name("lookup")
+                .about("Looks up symbols by address or by name in a resymgen YAML file and its subregion files")
+                .args(&[
+                    Arg::with_name("binary version")
+                        .help("Version of the binary to look up symbols in. By default, all versions are searched.")
+                        .takes_value(true)
+                        .short("v")
+                        .long("binary-version")
+                        .multiple(true)
+                        .number_of_values(1),
+                    Arg::with_name("input")
+                        .help("Input resymgen YAML file name")
+                        .required(true)
+                        .index(1),
+                    Arg::with_name("hex")
+                        .help("Parse addresses without a 0x prefix as hexadecimal (the default for queries read from standard input)")
+                        .short("x")
+                        .long("hex"),
+                    Arg::with_name("decimal")
+                        .help("Parse addresses without a 0x prefix as decimal (the default for queries passed as arguments)")
+                        .short("d")
+                        .long("decimal")
+                        .conflicts_with("hex"),
+                    Arg::with_name("query")
+                        .help("Addresses (with a 0x prefix for hexadecimal) or symbol names to look up. If omitted, newline-separated queries are read from standard input. Invalid addresses produce an error line in place of their results, and a nonzero exit status once all the queries have been answered.")
+                        .multiple(true)
+                        .index(2),
+                ]),
+        )
         .subcommand(
             SubCommand::with_name("merge")
                 .about("Merge one or more data files into a resymgen YAML file and its subregion files")
@@ -258,6 +314,8 @@ fn run_resymgen() -> Result<(), Box<dyn Error>> {
             let output_versions: Option<Vec<_>> =
                 matches.values_of("binary version").map(|v| v.collect());
             let sort_output = matches.is_present("sort");
+            let jobs = value_t!(matches, "jobs", usize)?;
+            let stream = matches.is_present("stream");
 
             let mut errors = Vec::with_capacity(input_files.len());
             for input_file in input_files {
@@ -266,13 +324,24 @@ fn run_resymgen() -> Result<(), Box<dyn Error>> {
                         .file_stem()
                         .ok_or("Empty input file name")?;
                     let output_base = Path::new(output_dir).join(input_file_stem);
-                    resymgen::generate_symbol_tables(
-                        input_file,
-                        output_formats.clone(),
-                        output_versions.clone(),
-                        sort_output,
-                        output_base,
-                    )?;
+                    if stream {
+                        resymgen::generate_symbol_tables_streaming(
+                            input_file,
+                            output_formats.clone(),
+                            output_versions.clone(),
+                            sort_output,
+                            output_base,
+                        )?;
+                    } else {
+                        resymgen::generate_symbol_tables_parallel(
+                            input_file,
+                            output_formats.clone(),
+                            output_versions.clone(),
+                            sort_output,
+                            output_base,
+                            jobs,
+                        )?;
+                    }
                     Ok(())
                 };
                 if let Err(e) = run_gen() {
@@ -296,27 +365,15 @@ fn run_resymgen() -> Result<(), Box<dyn Error>> {
             let recursive = matches.is_present("recursive");
             let iformat = int_format(matches.is_present("decimal"));
             if matches.is_present("check") {
-                let mut errors = Vec::with_capacity(input_files.len());
-                let mut failed = false;
-                for input_file in input_files {
-                    match resymgen::format_check_file(input_file, recursive, iformat) {
-                        Ok(success) => {
-                            if !success {
-                                println!();
-                                failed = true;
-                            }
-                        }
-                        Err(e) => errors.push((input_file.to_string(), e)),
-                    };
-                }
-                if !errors.is_empty() {
-                    return Err(MultiFileError {
-                        base_msg: "Could not complete format check".to_string(),
-                        errors,
-                    }
-                    .into());
-                }
-                if failed {
+                let cache_file = matches
+                    .value_of("cache")
+                    .map(|dir| Path::new(dir).join("fmt.json"));
+                if !resymgen::format_check_files(
+                    input_files.collect::<Vec<_>>(),
+                    recursive,
+                    iformat,
+                    cache_file.as_deref(),
+                )? {
                     return Err("Formatting issues detected.".into());
                 }
             } else {
@@ -371,14 +428,50 @@ fn run_resymgen() -> Result<(), Box<dyn Error>> {
                     convs.map(naming_convention).collect(),
                 ));
             }
+            let jobs = value_t!(matches, "jobs", usize)?;
+            let cache_file = matches
+                .value_of("cache")
+                .map(|dir| Path::new(dir).join("check.json"));
             // This one handles multiple files internally so that check result printing
             // can be merged appropriately
-            if !resymgen::run_and_print_checks(input_files.collect::<Vec<_>>(), &checks, recursive)?
-            {
+            if !resymgen::run_and_print_checks_parallel(
+                input_files.collect::<Vec<_>>(),
+                &checks,
+                recursive,
+                jobs,
+                cache_file.as_deref(),
+            )? {
                 return Err("Checks did not pass".into());
             }
             Ok(())
         }
+        Some("lookup") => {
+            let matches = matches.subcommand_matches("lookup").unwrap();
+
+            let input_file = matches.value_of("input").unwrap();
+            let versions: Option<Vec<_>> = matches.values_of("binary version").map(|v| v.collect());
+            let index = resymgen::load_symbol_index(input_file, versions)?;
+
+            let stdout = io::stdout();
+            let output = io::BufWriter::new(stdout.lock());
+            let queries = matches.values_of("query");
+            // Bare numbers default to hexadecimal on standard input, where the queries are
+            // usually addresses from logs or dumps, which rarely have a 0x prefix
+            let bare_format = if matches.is_present("hex") {
+                resymgen::IntFormat::Hexadecimal
+            } else if matches.is_present("decimal") || queries.is_some() {
+                resymgen::IntFormat::Decimal
+            } else {
+                resymgen::IntFormat::Hexadecimal
+            };
+            match queries {
+                Some(queries) => {
+                    let queries = queries.collect::<Vec<_>>().join("\n");
+                    index.answer_queries(queries.as_bytes(), output, bare_format)
+                }
+                None => index.answer_queries(io::stdin().lock(), output, bare_format),
+            }
+        }
         Some("merge") => {
             let matches = matches.subcommand_matches("merge").unwrap();
 
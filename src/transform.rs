@@ -1,17 +1,22 @@
 //! Data transformations involving the `resymgen` YAML format and other formats. Implements the
-//! `gen` and `merge` commands.
+//! `gen`, `merge`, and `lookup` commands.
 
 use std::borrow::Cow;
 use std::collections::BTreeSet;
 use std::convert::AsRef;
 use std::error::Error;
 use std::fs::{self, File};
+use std::io::{BufWriter, Write};
 use std::path::{Path, PathBuf};
 
 use tempfile::NamedTempFile;
 
-use super::data_formats::symgen_yml::{IntFormat, LoadParams, Sort, Subregion, SymGen, Symbol};
+use super::data_formats::symgen_yml::{
+    self, Block, BlockWriter, IntFormat, LoadParams, Sort, Subregion, SubregionError, SymGen,
+    Symbol, SymbolList,
+};
 use super::data_formats::{Generate, InFormat, OutFormat};
+use super::lookup::SymbolIndex;
 use super::util;
 
 /// Forms the output file path from the base, version, and format.
@@ -40,25 +45,53 @@ fn output_file_name(base: &Path, version: &str, format: &OutFormat) -> PathBuf {
         .with_extension(format.extension())
 }
 
-/// Generates symbol tables from a given SymGen struct for multiple different formats/versions.
-fn generate_symbols<P: AsRef<Path>>(
+/// Generates the symbol table for a single format/version to the appropriate file under
+/// `output_base`.
+fn generate_symbol_table(
     symgen: &SymGen,
+    fmt: &OutFormat,
+    version: &str,
+    output_base: &Path,
+) -> Result<(), Box<dyn Error>> {
+    // Write to a tempfile first, then persist atomically.
+    let output_file = output_file_name(output_base, version, fmt);
+    let f_gen = NamedTempFile::new()?;
+    let mut writer = BufWriter::new(&f_gen);
+    fmt.generate(&mut writer, symgen, version)?;
+    writer.flush()?;
+    drop(writer);
+    // Make sure the parent directory exists first
+    if let Some(parent) = output_file.parent() {
+        fs::create_dir_all(parent)?;
+    }
+    util::persist_named_temp_file_safe(f_gen, output_file)?;
+    Ok(())
+}
+
+/// Generates symbol tables from a given SymGen struct for multiple different formats/versions,
+/// on up to `jobs` threads.
+///
+/// Every format/version pair is generated independently by a single worker thread. If any of
+/// them fail, the error for the first failing pair (in order of `formats`, then `versions`) is
+/// returned, but all the other pairs are still generated.
+fn generate_symbols<P: AsRef<Path>>(
+    symgen: SymGen,
     formats: &[OutFormat],
-    versions: &[&str],
+    versions: &[String],
     output_base: P,
+    jobs: usize,
 ) -> Result<(), Box<dyn Error>> {
-    for fmt in formats.iter() {
-        for version in versions.iter() {
-            // Write to a tempfile first, then persist atomically.
-            let output_file = output_file_name(output_base.as_ref(), version, fmt);
-            let f_gen = NamedTempFile::new()?;
-            fmt.generate(&f_gen, symgen, version)?;
-            // Make sure the parent directory exists first
-            if let Some(parent) = output_file.parent() {
-                fs::create_dir_all(parent)?;
-            }
-            util::persist_named_temp_file_safe(f_gen, output_file)?;
-        }
+    let tasks: Vec<(OutFormat, String)> = formats
+        .iter()
+        .flat_map(|fmt| versions.iter().map(move |v| (*fmt, v.clone())))
+        .collect();
+    let output_base = output_base.as_ref().to_path_buf();
+    // Box<dyn Error> isn't Send, so errors are passed back as messages
+    let results = util::parallel_map(tasks, jobs, move |(fmt, version)| {
+        generate_symbol_table(&symgen, fmt, version, &output_base).map_err(|e| e.to_string())
+    });
+    for r in results {
+        r?;
     }
     Ok(())
 }
@@ -112,12 +145,25 @@ fn all_version_names(symgen: &SymGen) -> Vec<&str> {
     vers.into_iter().collect()
 }
 
+/// Reads a SymGen from `input_file`, along with all its subregions collapsed into it.
+fn read_collapsed<P: AsRef<Path>>(input_file: P) -> Result<SymGen, Box<dyn Error>> {
+    let input_file = input_file.as_ref();
+    let mut contents = {
+        let file = File::open(input_file)?;
+        SymGen::read(&file)?
+    };
+    contents.resolve_subregions(Subregion::subregion_dir(input_file), |p| File::open(p))?;
+    contents.collapse_subregions();
+    Ok(contents)
+}
+
 /// Generates symbol tables from a given `input_file` for multiple different `output_formats` and
 /// `output_versions`.
 ///
-/// Output is written to filepaths based on `output_base`. Both `output_formats` and
-/// `output_versions` default to all formats/versions if `None`. If `sort_output` is true, the
-/// function and data sections of the output symbol tables will each be sorted by symbol address.
+/// Output is written to filepaths based on `output_base`. `output_formats` defaults to
+/// [`OutFormat::defaults`] and `output_versions` defaults to all versions if `None`. If
+/// `sort_output` is true, the function and data sections of the output symbol tables will each be
+/// sorted by symbol address.
 ///
 /// # Examples
 /// ```ignore
@@ -137,6 +183,100 @@ pub fn generate_symbol_tables<'v, I, F, V, O>(
     sort_output: bool,
     output_base: O,
 ) -> Result<(), Box<dyn Error>>
+where
+    I: AsRef<Path>,
+    F: AsRef<[OutFormat]>,
+    V: AsRef<[&'v str]>,
+    O: AsRef<Path>,
+{
+    generate_symbol_tables_parallel(
+        input_file,
+        output_formats,
+        output_versions,
+        sort_output,
+        output_base,
+        1,
+    )
+}
+
+/// Same as [`generate_symbol_tables`], but generates the symbol tables for different
+/// formats/versions concurrently, on up to `jobs` threads.
+///
+/// # Examples
+/// ```ignore
+/// generate_symbol_tables_parallel(
+///     "/path/to/symbols.yml",
+///     None::<&[OutFormat]>,
+///     None::<&[&str]>,
+///     false,
+///     "/path/to/out/symbols",
+///     8,
+/// )
+/// .expect("failed to generate symbol tables");
+/// ```
+pub fn generate_symbol_tables_parallel<'v, I, F, V, O>(
+    input_file: I,
+    output_formats: Option<F>,
+    output_versions: Option<V>,
+    sort_output: bool,
+    output_base: O,
+    jobs: usize,
+) -> Result<(), Box<dyn Error>>
+where
+    I: AsRef<Path>,
+    F: AsRef<[OutFormat]>,
+    V: AsRef<[&'v str]>,
+    O: AsRef<Path>,
+{
+    let mut contents = read_collapsed(input_file)?;
+    if sort_output {
+        contents.sort();
+    }
+
+    let formats = match &output_formats {
+        Some(f) => Cow::Borrowed(f.as_ref()),
+        None => Cow::Owned(OutFormat::defaults().collect::<Vec<_>>()),
+    };
+    let versions: Vec<String> = match &output_versions {
+        Some(v) => v.as_ref().iter().map(|v| v.to_string()).collect(),
+        None => all_version_names(&contents)
+            .into_iter()
+            .map(String::from)
+            .collect(),
+    };
+
+    generate_symbols(contents, &formats, &versions, output_base, jobs)
+}
+
+/// Like [`generate_symbol_tables`], but reads and writes the input one file at a time.
+///
+/// Each block is written to all the output symbol tables on its own, and its symbols are released
+/// right after. The subregion files of a block are then resolved and written one at a time, in the
+/// same way, and each is dropped once it has been written. This way, only the files along a single
+/// chain of nested subregions are loaded at once, rather than the entire subregion tree.
+///
+/// The exceptions are the [`ld_free`] and [`sym_index`] formats, which need all the symbols in a
+/// block at once (see [`BlockWriter::needs_collapsed_blocks`]). If either of them is requested,
+/// each top-level block is loaded along with all of its subregions before being written, which
+/// saves nothing over [`generate_symbol_tables`] for input files with a single top-level block.
+///
+/// Other differences from [`generate_symbol_tables`]:
+/// - If `output_versions` is `None`, the versions are inferred from the top-level `input_file`
+///   alone, not from its subregions.
+/// - The symbols of each block are written before those of its subregions, rather than being
+///   merged into a single block. For the text formats, this groups the functions and data by file
+///   rather than by symbol type (see [`OutFormat::block_writer`]), and with `sort_output`, the
+///   symbols are sorted within each file rather than across the whole block.
+///
+/// [`ld_free`]: super::data_formats::ld_free
+/// [`sym_index`]: super::data_formats::sym_index
+pub fn generate_symbol_tables_streaming<'v, I, F, V, O>(
+    input_file: I,
+    output_formats: Option<F>,
+    output_versions: Option<V>,
+    sort_output: bool,
+    output_base: O,
+) -> Result<(), Box<dyn Error>>
 where
     I: AsRef<Path>,
     F: AsRef<[OutFormat]>,
@@ -148,22 +288,125 @@ where
         let file = File::open(input_file)?;
         SymGen::read(&file)?
     };
-    contents.resolve_subregions(Subregion::subregion_dir(input_file), |p| File::open(p))?;
-    contents.collapse_subregions();
-    if sort_output {
-        contents.sort();
-    }
 
     let formats = match &output_formats {
         Some(f) => Cow::Borrowed(f.as_ref()),
-        None => Cow::Owned(OutFormat::all().collect::<Vec<_>>()),
+        None => Cow::Owned(OutFormat::defaults().collect::<Vec<_>>()),
     };
-    let versions = match &output_versions {
-        Some(v) => Cow::Borrowed(v.as_ref()),
-        None => Cow::Owned(all_version_names(&contents)),
+    let versions: Vec<String> = match &output_versions {
+        Some(v) => v.as_ref().iter().map(|v| v.to_string()).collect(),
+        None => all_version_names(&contents)
+            .into_iter()
+            .map(String::from)
+            .collect(),
     };
 
-    generate_symbols(&contents, &formats, &versions, output_base)
+    // Write to tempfiles first, then persist atomically.
+    let mut output_files = Vec::with_capacity(formats.len() * versions.len());
+    for fmt in formats.iter() {
+        for version in versions.iter() {
+            output_files.push((
+                output_file_name(output_base.as_ref(), version, fmt),
+                NamedTempFile::new()?,
+                fmt,
+                version,
+            ));
+        }
+    }
+    let mut writers = output_files
+        .iter()
+        .map(|(_, f_gen, fmt, version)| fmt.block_writer(BufWriter::new(f_gen.as_file()), version))
+        .collect::<Result<Vec<_>, _>>()?;
+
+    let subregion_dir = Subregion::subregion_dir(input_file);
+    let collapse = writers.iter().any(|wtr| wtr.needs_collapsed_blocks());
+    for (name, block) in contents.iter_mut() {
+        if collapse {
+            block.resolve_subregions(&subregion_dir, |p| File::open(p))?;
+            block.collapse_subregions();
+        }
+        stream_block(&mut writers, &name.val, block, &subregion_dir, sort_output)?;
+    }
+    for wtr in writers {
+        wtr.finish()?;
+    }
+
+    for (output_file, f_gen, _, _) in output_files {
+        // Make sure the parent directory exists first
+        if let Some(parent) = output_file.parent() {
+            fs::create_dir_all(parent)?;
+        }
+        util::persist_named_temp_file_safe(f_gen, output_file)?;
+    }
+    Ok(())
+}
+
+/// Writes `block` (named `block_name`) to all the `writers`, followed by the blocks within each of
+/// its subregions in turn. Subregion files are resolved relative to `subregion_dir` one at a time,
+/// right before they're written, and dropped right after.
+fn stream_block(
+    writers: &mut [Box<dyn BlockWriter + '_>],
+    block_name: &str,
+    block: &mut Block,
+    subregion_dir: &Path,
+    sort_output: bool,
+) -> Result<(), Box<dyn Error>> {
+    let subregions = block.subregions.take();
+    if sort_output {
+        block.sort();
+    }
+    for wtr in writers.iter_mut() {
+        wtr.write_block(block_name, block)?;
+    }
+    // The block won't be needed again, so free up its symbols
+    block.functions = SymbolList::from([]);
+    block.data = SymbolList::from([]);
+
+    for mut subregion in subregions.into_iter().flatten() {
+        subregion.resolve(subregion_dir, |p| File::open(p))?;
+        // Explicitly block symlinks, like Block::resolve_subregions() does
+        let subdir = subregion_dir.join(Subregion::subregion_dir(&subregion.name));
+        if subdir.is_symlink() {
+            return Err(symgen_yml::Error::Subregion(SubregionError::Symlink(subdir)).into());
+        }
+        let mut contents = subregion
+            .contents
+            .take()
+            .expect("subregion not resolved after Subregion::resolve()");
+        for (name, sub_block) in contents.iter_mut() {
+            stream_block(writers, &name.val, sub_block, &subdir, sort_output)?;
+        }
+    }
+    Ok(())
+}
+
+/// Builds a [`SymbolIndex`] for looking up symbols by address or name from a given `input_file`
+/// (including its subregions) for the given `versions`.
+///
+/// `versions` defaults to all versions if `None`.
+///
+/// # Examples
+/// ```ignore
+/// let index = load_symbol_index("/path/to/symbols.yml", Some(["v1"]))
+///     .expect("failed to load symbol index");
+/// for m in index.lookup_address("v1", 0x2001000) {
+///     println!("{}", m.symbol.map_or(m.block, |s| &s.name));
+/// }
+/// ```
+pub fn load_symbol_index<'v, I, V>(
+    input_file: I,
+    versions: Option<V>,
+) -> Result<SymbolIndex, Box<dyn Error>>
+where
+    I: AsRef<Path>,
+    V: AsRef<[&'v str]>,
+{
+    let contents = read_collapsed(input_file)?;
+    let index = match &versions {
+        Some(v) => SymbolIndex::new(&contents, v.as_ref()),
+        None => SymbolIndex::new(&contents, &all_version_names(&contents)),
+    };
+    Ok(index)
 }
 
 /// Merges symbols from a collection of `input_files` of the format `input_format` into a given
@@ -345,4 +588,187 @@ mod tests {
 
         assert_eq!(all_version_names(&s), Vec::<&str>::new());
     }
+
+    #[test]
+    fn test_generate_symbol_tables_modes() {
+        let dir = tempfile::tempdir().expect("Failed to create temp dir");
+        let input_file = dir.path().join("top.yml");
+        fs::create_dir_all(dir.path().join("top").join("sub")).unwrap();
+        fs::write(
+            &input_file,
+            r"
+            main:
+              versions:
+                - v1
+                - v2
+              address: 0x2000000
+              length: 0x100000
+              subregions:
+                - sub.yml
+              functions:
+                - name: fn1
+                  address:
+                    v1: 0x2001000
+                    v2: 0x2002000
+                  length: 0x100
+              data:
+                - name: MAIN_DATA
+                  address: 0x2080000
+                  length: 4
+            other:
+              versions:
+                - v1
+                - v2
+              address: 0x2400000
+              length: 0x1000
+              functions:
+                - name: other_fn
+                  address: 0x2400000
+              data: []
+            ",
+        )
+        .unwrap();
+        fs::write(
+            dir.path().join("top").join("sub.yml"),
+            r"
+            sub:
+              versions:
+                - v1
+                - v2
+              address: 0x2000000
+              length: 0x1000
+              subregions:
+                - inner.yml
+              functions:
+                - name: fn0
+                  address: 0x2000000
+              data:
+                - name: SOME_DATA
+                  address: 0x2000800
+                  length: 4
+            ",
+        )
+        .unwrap();
+        fs::write(
+            dir.path().join("top").join("sub").join("inner.yml"),
+            r"
+            inner:
+              versions:
+                - v1
+                - v2
+              address: 0x2000C00
+              length: 0x100
+              functions:
+                - name: inner_fn
+                  address: 0x2000C00
+              data: []
+            ",
+        )
+        .unwrap();
+
+        let out_dir = tempfile::tempdir().expect("Failed to create temp dir");
+        let out_base = |mode: &str| out_dir.path().join(mode).join("top");
+        let read_output = |mode: &str, version: &str, fmt: OutFormat| {
+            let name = output_file_name(Path::new("top"), version, &fmt);
+            fs::read(out_dir.path().join(mode).join(name)).unwrap()
+        };
+        let all_formats: Vec<_> = OutFormat::all().collect();
+        let collapsed_formats = [OutFormat::LdFree, OutFormat::SymIndex];
+        let streamed_formats: Vec<_> = OutFormat::all()
+            .filter(|fmt| !matches!(fmt, OutFormat::LdFree | OutFormat::SymIndex))
+            .collect();
+        generate_symbol_tables(
+            &input_file,
+            Some(&all_formats),
+            None::<&[&str]>,
+            true,
+            out_base("eager"),
+        )
+        .expect("generate_symbol_tables failed");
+        generate_symbol_tables_parallel(
+            &input_file,
+            Some(&all_formats),
+            None::<&[&str]>,
+            true,
+            out_base("parallel"),
+            4,
+        )
+        .expect("generate_symbol_tables_parallel failed");
+        generate_symbol_tables_streaming(
+            &input_file,
+            Some(&streamed_formats),
+            None::<&[&str]>,
+            true,
+            out_base("streaming"),
+        )
+        .expect("generate_symbol_tables_streaming failed");
+        generate_symbol_tables_streaming(
+            &input_file,
+            Some(&collapsed_formats),
+            None::<&[&str]>,
+            true,
+            out_base("streaming-collapsed"),
+        )
+        .expect("generate_symbol_tables_streaming failed");
+
+        for version in ["v1", "v2"] {
+            for fmt in all_formats.iter().copied() {
+                assert_eq!(
+                    read_output("eager", version, fmt),
+                    read_output("parallel", version, fmt),
+                    "{} {:?} differs",
+                    version,
+                    fmt
+                );
+            }
+            // Formats that need collapsed blocks are the same as eager output even when streamed
+            for fmt in collapsed_formats.iter().copied() {
+                assert_eq!(
+                    read_output("eager", version, fmt),
+                    read_output("streaming-collapsed", version, fmt),
+                    "{} {:?} differs",
+                    version,
+                    fmt
+                );
+            }
+        }
+
+        // Eager output merges subregions into their parent block, and lists all functions
+        // before all data
+        assert_eq!(
+            String::from_utf8(read_output("eager", "v1", OutFormat::Ghidra)).unwrap(),
+            concat!(
+                "fn0 2000000 f\n",
+                "inner_fn 2000C00 f\n",
+                "fn1 2001000 f\n",
+                "other_fn 2400000 f\n",
+                "SOME_DATA 2000800 l\n",
+                "MAIN_DATA 2080000 l\n",
+            )
+        );
+        // Streamed output lists the functions and then the data of each block in turn, with
+        // each block followed by the blocks in its subregions, and each block sorted on its own
+        assert_eq!(
+            String::from_utf8(read_output("streaming", "v1", OutFormat::Ghidra)).unwrap(),
+            concat!(
+                "fn1 2001000 f\n",
+                "MAIN_DATA 2080000 l\n",
+                "fn0 2000000 f\n",
+                "SOME_DATA 2000800 l\n",
+                "inner_fn 2000C00 f\n",
+                "other_fn 2400000 f\n",
+            )
+        );
+        assert_eq!(
+            String::from_utf8(read_output("streaming", "v2", OutFormat::Sym)).unwrap(),
+            concat!(
+                "02002000 fn1\n",
+                "02080000 MAIN_DATA\n",
+                "02000000 fn0\n",
+                "02000800 SOME_DATA\n",
+                "02000C00 inner_fn\n",
+                "02400000 other_fn\n",
+            )
+        );
+    }
 }
@@ -1,7 +1,13 @@
+use std::cmp;
 use std::error::Error;
 use std::fmt::{self, Display, Formatter};
 use std::fs;
+use std::iter;
+use std::panic;
 use std::path::Path;
+use std::sync::atomic::{AtomicUsize, Ordering};
+use std::sync::{mpsc, Arc};
+use std::thread;
 
 use tempfile::{NamedTempFile, PersistError};
 
@@ -70,3 +76,59 @@ pub fn symgen_write_recursive<P: AsRef<Path>>(
     }
     Ok(())
 }
+
+/// Applies `f` to each of the `items` on up to `jobs` worker threads, and returns the results in
+/// the same order as `items`, regardless of the order in which the workers finish.
+///
+/// Workers take the next unprocessed item as soon as they're done with the previous one. If `jobs`
+/// is 1 or less, the items are processed in order on the calling thread instead. A panic within `f`
+/// is propagated to the caller once all the workers have finished.
+pub fn parallel_map<T, R, F>(items: Vec<T>, jobs: usize, f: F) -> Vec<R>
+where
+    T: Send + Sync + 'static,
+    R: Send + 'static,
+    F: Fn(&T) -> R + Send + Sync + 'static,
+{
+    let jobs = cmp::min(jobs, items.len());
+    if jobs <= 1 {
+        return items.iter().map(f).collect();
+    }
+
+    let n_items = items.len();
+    let items = Arc::new(items);
+    let f = Arc::new(f);
+    let next_item = Arc::new(AtomicUsize::new(0));
+    let (tx, rx) = mpsc::channel();
+    let workers: Vec<_> = (0..jobs)
+        .map(|_| {
+            let items = Arc::clone(&items);
+            let f = Arc::clone(&f);
+            let next_item = Arc::clone(&next_item);
+            let tx = tx.clone();
+            thread::spawn(move || loop {
+                let i = next_item.fetch_add(1, Ordering::Relaxed);
+                if i >= items.len() {
+                    break;
+                }
+                if tx.send((i, f(&items[i]))).is_err() {
+                    break;
+                }
+            })
+        })
+        .collect();
+    drop(tx);
+
+    let mut results: Vec<_> = iter::repeat_with(|| None).take(n_items).collect();
+    for (i, result) in rx {
+        results[i] = Some(result);
+    }
+    for worker in workers {
+        if let Err(e) = worker.join() {
+            panic::resume_unwind(e);
+        }
+    }
+    results
+        .into_iter()
+        .map(|r| r.expect("worker finished without processing its item"))
+        .collect()
+}
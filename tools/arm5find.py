@@ -16,11 +16,21 @@ python3 arm5find.py -d 0x77330 0x14 </path/to/overlay29_NA.bin> </path/to/overla
 You can include more than one `-a`/`-d` inputs to search for multiple segments
 at once. You can also include more than one target file to search multiple
 files at once.
+
+When searching for many segments at once, use the multi-pattern engine
+(`-e multi`), optionally with multiple jobs (`-j`) to search target files in
+parallel. Rather than scanning each target once per segment, it indexes each
+target once, and looks up every segment against the index. Unlike the default
+regex engine, the multi-pattern engine only reports assembly matches at word-
+aligned offsets (which is where ARM instructions are), and it reports
+overlapping matches individually.
 """
 
 import argparse
+from concurrent.futures import ProcessPoolExecutor
 import re
-from typing import BinaryIO, Iterator, List, Union
+import struct
+from typing import BinaryIO, Dict, Iterator, List, Tuple, Union
 
 
 class Segment:
@@ -101,6 +111,138 @@ class DataSegment(Segment):
         return f"data: {super().__repr__()}"
 
 
+ENGINE_REGEX = "regex"
+ENGINE_MULTI = "multi"
+ENGINES = [ENGINE_REGEX, ENGINE_MULTI]
+
+# Only the condition and opcode bits of a `bl` instruction (the most
+# significant byte) need to match; the offset can differ
+BL_MASK = 0xFF000000
+
+
+def normalized_words(data: bytes) -> List[int]:
+    """Get the complete little endian words in some data, with the offsets of
+    `bl` instructions masked out. Two aligned instruction sequences are
+    equivalent (in the sense of AsmSegment.regex()) iff their normalized words
+    are equal.
+    """
+    n = len(data) // AsmSegment.INSTRUCTION_SIZE
+    words = struct.unpack(f"<{n}I", data[: n * AsmSegment.INSTRUCTION_SIZE])
+    return [w & BL_MASK if (w >> 24) & 0b1111 == 0b1011 else w for w in words]
+
+
+class WordIndex:
+    """An index of the (normalized) words at each aligned offset within some
+    file contents, for quickly finding equivalent instruction sequences.
+
+    Each lookup is anchored on whichever word of the instruction sequence is
+    rarest in the contents, so only a handful of candidate offsets need to be
+    checked, no matter how large the contents are. Building the index takes a
+    single pass over the contents, after which any number of lookups can be
+    done.
+    """
+
+    def __init__(self, contents: bytes):
+        self.contents = contents
+        self.words = normalized_words(contents)
+        # Offsets (in words) of each distinct normalized word
+        self.offsets: Dict[int, List[int]] = {}
+        for offset, word in enumerate(self.words):
+            self.offsets.setdefault(word, []).append(offset)
+
+    def find_asm(self, raw: bytes) -> List[int]:
+        """Find instruction sequences equivalent to some raw instructions
+
+        Args:
+            raw (bytes): raw instructions to search for
+
+        Returns:
+            List[int]: word-aligned byte offsets of all matches, in order
+        """
+        size = AsmSegment.INSTRUCTION_SIZE
+        pattern = normalized_words(raw)
+        tail = raw[len(pattern) * size :]
+        contents = self.contents
+        if not pattern:
+            # Shorter than an instruction; just look for aligned bytes
+            found = []
+            start = contents.find(tail)
+            while start >= 0:
+                if start % size == 0:
+                    found.append(start)
+                start = contents.find(tail, start + 1)
+            return found
+
+        anchor = min(
+            range(len(pattern)), key=lambda j: len(self.offsets.get(pattern[j], ()))
+        )
+        found = []
+        for offset in self.offsets.get(pattern[anchor], ()):
+            start = offset - anchor
+            end = start * size + len(raw)
+            if (
+                start >= 0
+                and self.words[start : start + len(pattern)] == pattern
+                and contents[end - len(tail) : end] == tail
+            ):
+                found.append(start * size)
+        return found
+
+
+class MultiSegmentMatcher:
+    """Matches a collection of segments from a source file against target
+    files, in a single pass over each target file.
+
+    Assembly segments are matched instruction-by-instruction with a WordIndex
+    of the target. Data segments are matched as raw bytes at any offset.
+    """
+
+    def __init__(self, src_file: BinaryIO, segments: List[Segment]):
+        self.segments = segments
+        # (segment index, raw bytes)
+        self.asm_patterns: List[Tuple[int, bytes]] = []
+        self.data_patterns: List[Tuple[int, bytes]] = []
+        for i, seg in enumerate(segments):
+            raw = seg.read(src_file)
+            if isinstance(seg, AsmSegment):
+                self.asm_patterns.append((i, raw))
+            else:
+                self.data_patterns.append((i, raw))
+
+    def search(self, contents: bytes) -> List[List[Segment]]:
+        """Search some file contents for all segments
+
+        Args:
+            contents (bytes): contents of the target file
+
+        Returns:
+            List[List[Segment]]: matches by source segment, in order of offset
+        """
+        matches: List[List[Segment]] = [[] for _ in self.segments]
+        if self.asm_patterns:
+            index = WordIndex(contents)
+            for i, raw in self.asm_patterns:
+                matches[i] = [
+                    Segment(start, len(raw)) for start in index.find_asm(raw)
+                ]
+        for i, raw in self.data_patterns:
+            start = contents.find(raw)
+            while start >= 0:
+                matches[i].append(Segment(start, len(raw)))
+                start = contents.find(raw, start + 1)
+        return matches
+
+
+def _multi_search_file(
+    matcher: MultiSegmentMatcher, target_fname: str
+) -> List[List[Segment]]:
+    """Search a single target file with a MultiSegmentMatcher. This is a
+    top-level function so it can be run in a worker process.
+    """
+    with open(target_fname, "rb") as target_file:
+        return matcher.search(target_file.read())
+
+
 def armv5_search(
     src_filename: str,
     target_filenames: List[str],
@@ -108,6 +250,8 @@ def armv5_search(
     *,
     self_matches: bool = False,
     verbose: bool = False,
+    engine: str = ENGINE_REGEX,
+    jobs: int = 1,
 ) -> List[List[List[Segment]]]:
     """Search through target ARMv5 binary files for contents from a source file
 
@@ -117,6 +261,8 @@ def armv5_search(
         segments (List[Segment]): segments within the source file to match
         self_matches (bool, optional): include self-matches if searching the source file. Defaults to False.
         verbose (bool, optional): verbose printing. Defaults to False.
+        engine (str, optional): search engine, one of ENGINES. Defaults to ENGINE_REGEX.
+        jobs (int, optional): number of target files to search in parallel with the multi-pattern engine. Defaults to 1.
 
     Returns:
         List[List[List[Segment]]]: Search results, as a list of matches by source segment, by target file
@@ -127,6 +273,51 @@ def armv5_search(
         [[] for s in range(len(target_filenames))] for t in range(len(segments))
     ]
 
+    def add_match(
+        t: int,
+        target_fname: str,
+        seg_matches: List[List[Segment]],
+        seg: Segment,
+        match_segment: Segment,
+    ):
+        if (
+            not self_matches
+            and target_fname == src_filename
+            and match_segment == seg
+        ):
+            # Omit the original segment within the source file,
+            # which is a guaranteed match
+            return
+        seg_matches[t].append(match_segment)
+
+    if engine == ENGINE_MULTI:
+        with open(src_filename, "rb") as src_file:
+            matcher = MultiSegmentMatcher(src_file, segments)
+        if jobs > 1 and len(target_filenames) > 1:
+            with ProcessPoolExecutor(max_workers=jobs) as executor:
+                results_by_target = list(
+                    executor.map(
+                        _multi_search_file,
+                        [matcher] * len(target_filenames),
+                        target_filenames,
+                    )
+                )
+        else:
+            results_by_target = [
+                _multi_search_file(matcher, fname) for fname in target_filenames
+            ]
+        for t, (target_fname, target_results) in enumerate(
+            zip(target_filenames, results_by_target)
+        ):
+            for seg, seg_matches, matches in zip(
+                segments, search_results, target_results
+            ):
+                for match_segment in matches:
+                    add_match(t, target_fname, seg_matches, seg, match_segment)
+        return search_results
+    elif engine != ENGINE_REGEX:
+        raise ValueError(f"unknown search engine: {engine}")
+
     # Perform the search
     with open(src_filename, "rb") as src_file:
         # Compile all the search regexes up front to avoid repeating the work with
@@ -152,15 +343,7 @@ def armv5_search(
                         match_segment = Segment(
                             match.start(), match.end() - match.start()
                         )
-                        if (
-                            not self_matches
-                            and target_fname == src_filename
-                            and match_segment == seg
-                        ):
-                            # Omit the original segment within the source file,
-                            # which is a guaranteed match
-                            continue
-                        seg_matches[t].append(match_segment)
+                        add_match(t, target_fname, seg_matches, seg, match_segment)
     return search_results
 
 
@@ -192,6 +375,20 @@ if __name__ == "__main__":
         action="store_true",
         help="include self-matches from the source file in search results",
     )
+    parser.add_argument(
+        "-e",
+        "--engine",
+        choices=ENGINES,
+        default=ENGINE_REGEX,
+        help="search engine; the multi-pattern engine is much faster for many segments",
+    )
+    parser.add_argument(
+        "-j",
+        "--jobs",
+        type=int,
+        default=1,
+        help="number of target files to search in parallel (multi-pattern engine only)",
+    )
     parser.add_argument("-v", "--verbose", action="store_true", help="verbose output")
     parser.add_argument(
         "source", help="source binary file to take search segments from"
@@ -215,6 +412,8 @@ if __name__ == "__main__":
         segments,
         self_matches=args.include_self_matches,
         verbose=args.verbose,
+        engine=args.engine,
+        jobs=args.jobs,
     )
 
     # Report search results
@@ -0,0 +1,56 @@
+"""
+Shared helpers for the tools that read data tables out of EoS binaries, such as
+`script_vars.py` and `type_matchups.py`.
+
+Table addresses are read from the pmdsky-debug symbol tables, so this module
+requires PyYAML.
+"""
+
+import functools
+from pathlib import Path
+import yaml
+
+import offsets
+
+SYMBOLS_DIR = Path(__file__).resolve().parent.parent / "symbols"
+
+
+class BinaryFile:
+    """A binary file (e.g., arm9.bin) for a specific game version"""
+
+    def __init__(self, path: str, version: str, name: str):
+        """
+        Args:
+            path (str): path to the binary file
+            version (str): game version
+            name (str): binary name, as used in the symbol tables (e.g., "arm9")
+        """
+        self.data = Path(path).read_bytes()
+        self.version = version
+        self.name = name
+        self.binary = offsets.BINARIES[version][name]
+
+    def read(self, address: int, length: int) -> bytes:
+        start = self.binary.relative(address)
+        if start + length > len(self.data):
+            raise ValueError(f"address 0x{address:X} is out of bounds")
+        return self.data[start : start + length]
+
+    def read_cstring(self, address: int) -> str:
+        start = self.binary.relative(address)
+        end = self.data.index(b"\0", start)
+        return self.data[start:end].decode("ascii")
+
+    def table_address(self, symbol_name: str) -> int:
+        """Get the address of a data symbol in this binary from the symbol tables"""
+        symbol_file = SYMBOLS_DIR / f"{self.name}.yml"
+        for symbol in load_symbols(symbol_file)[self.name]["data"]:
+            if symbol["name"] == symbol_name:
+                return symbol["address"][self.version]
+        raise KeyError(f"symbol {symbol_name} not found in {symbol_file}")
+
+
+@functools.lru_cache(maxsize=None)
+def load_symbols(symbol_file: Path) -> dict:
+    with symbol_file.open("r") as f:
+        return yaml.safe_load(f)
@@ -3,31 +3,50 @@
 # @category Data
 
 import json
+import os
 import ghidra.program.model.symbol.SourceType as SourceType
 
 COMMENT_TAG = "=== imported description ===\n"
+
 functionManager = currentProgram.getFunctionManager()
+symbolTable = currentProgram.getSymbolTable()
 
-jythonFile = askFile("Select symbol JSON file", "Import")
-with open(jythonFile.absolutePath, "r") as f:
-    symbols = json.load(f)
 
-for s in symbols:
-    stype = s["type"]
-    name = s["name"]
-    address = s["address"]
-    if type(address) != int:
-        address = int(address, 0)
-    address = toAddr(address)
-    description = s.get("description")
+def hasLabel(address, name, primary):
+    """Check if a label already exists, and is primary if it needs to be."""
+    for symbol in symbolTable.getSymbols(address):
+        if symbol.getName() == name:
+            return symbol.isPrimary() or not primary
+    return False
+
+
+def withDescription(comment, description):
+    """Replace the imported description in a plate comment."""
+    if not comment:
+        return COMMENT_TAG + description
+    commentParts = comment.split(COMMENT_TAG)
+    if len(commentParts) == 1:
+        commentParts[0] += "\n\n"
+        commentParts.append("")
+    commentParts[1] = description
+    return COMMENT_TAG.join(commentParts)
 
-    if stype == "function":
+
+def importSymbol(s, address):
+    """
+    Import a symbol, skipping anything that's already up to date. Returns the
+    number of changes made.
+    """
+    changes = 0
+    name = s["name"]
+    if s["type"] == "function":
         func = functionManager.getFunctionAt(address)
 
         if func is None:
             func = createFunction(address, name)
             print("Created function {} at address {}".format(name, address))
-        else:
+            changes += 1
+        elif func.getName() != name:
             old_name = func.getName()
             func.setName(name, SourceType.USER_DEFINED)
             print(
@@ -35,22 +54,47 @@ for s in symbols:
                     old_name, name, address
                 )
             )
-    else:
+            changes += 1
+    elif not hasLabel(address, name, True):
         print("Created primary label {} at address {}".format(name, address))
         createLabel(address, name, True)
+        changes += 1
     for alias in s.get("aliases", []):
-        print("Created label {} at address {}".format(alias, address))
-        createLabel(address, alias, False)
+        if not hasLabel(address, alias, False):
+            print("Created label {} at address {}".format(alias, address))
+            createLabel(address, alias, False)
+            changes += 1
 
+    description = s.get("description")
     if description:
         comment = getPlateComment(address)
-        if not comment:
-            comment = COMMENT_TAG + description
-        else:
-            commentParts = comment.split(COMMENT_TAG)
-            if len(commentParts) == 1:
-                commentParts[0] += "\n\n"
-                commentParts.append("")
-            commentParts[1] = description
-            comment = COMMENT_TAG.join(commentParts)
-        setPlateComment(address, comment)
+        newComment = withDescription(comment, description)
+        if newComment != comment:
+            setPlateComment(address, newComment)
+            changes += 1
+    return changes
+
+
+def importSymbols(fname, symbols, toAddress):
+    """
+    Import all the symbols from a file, and print the number of changes made.
+    """
+    changes = 0
+    for s in symbols:
+        monitor.checkCanceled()
+        address = s["address"]
+        if type(address) != int:
+            address = int(address, 0)
+        changes += importSymbol(s, toAddress(address))
+    print(
+        "{}: {} symbols, {} changes".format(
+            os.path.basename(fname), len(symbols), changes
+        )
+    )
+
+
+jythonFile = askFile("Select symbol JSON file", "Import")
+with open(jythonFile.absolutePath, "r") as f:
+    symbols = json.load(f)
+
+importSymbols(jythonFile.absolutePath, symbols, toAddr)
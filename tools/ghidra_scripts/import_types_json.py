@@ -0,0 +1,173 @@
+# Imports pmdsky-debug data types from a JSON type dump
+# @author UsernameFodder
+# @category Data
+
+# Type dumps are generated from the C headers with `make ghidra-types` in the
+# headers directory (see headers/ghidra_types.py for the format). Importing a
+# dump is much faster than parsing the headers with Ghidra's C parser, but only
+# covers data types (structs, unions, enums and typedefs), not function
+# signatures.
+#
+# All types are imported into the /pmdsky-debug category. Types that already
+# exist there are replaced, so the script can be rerun to refresh the types
+# after the headers are updated.
+
+import json
+from ghidra.program.model.data import (
+    AbstractIntegerDataType,
+    ArrayDataType,
+    BooleanDataType,
+    CategoryPath,
+    CharDataType,
+    DataTypeConflictHandler,
+    DoubleDataType,
+    EnumDataType,
+    FloatDataType,
+    PointerDataType,
+    StructureDataType,
+    TypedefDataType,
+    Undefined1DataType,
+    UnionDataType,
+    VoidDataType,
+)
+
+CATEGORY = CategoryPath("/pmdsky-debug")
+POINTER_SIZE = 4
+
+dtm = currentProgram.getDataTypeManager()
+
+builtins = {
+    "void": VoidDataType.dataType,
+    "char": CharDataType.dataType,
+    "bool": BooleanDataType.dataType,
+    "float": FloatDataType.dataType,
+    "double": DoubleDataType.dataType,
+}
+for size in (1, 2, 4, 8):
+    builtins["sint{}".format(size)] = AbstractIntegerDataType.getSignedDataType(
+        size, dtm
+    )
+    builtins["uint{}".format(size)] = AbstractIntegerDataType.getUnsignedDataType(
+        size, dtm
+    )
+
+types = {}
+
+
+def addType(dataType):
+    return dtm.addDataType(dataType, DataTypeConflictHandler.REPLACE_HANDLER)
+
+
+def resolve(ref):
+    if "name" in ref:
+        return types[ref["name"]]
+    if "builtin" in ref:
+        return builtins[ref["builtin"]]
+    if "pointer" in ref:
+        return PointerDataType(resolve(ref["pointer"]), POINTER_SIZE, dtm)
+    element = resolve(ref["array"])
+    return ArrayDataType(element, ref["count"], element.getLength(), dtm)
+
+
+def fillStruct(struct, composite):
+    for field in composite["fields"]:
+        fieldType = resolve(field["type"])
+        if "bit_size" in field:
+            struct.insertBitFieldAt(
+                field["offset"],
+                field["byte_width"],
+                field["bit_offset"],
+                fieldType,
+                field["bit_size"],
+                field["name"],
+                None,
+            )
+        elif fieldType.getLength() > 0:
+            struct.replaceAtOffset(
+                field["offset"], fieldType, fieldType.getLength(), field["name"], None
+            )
+        else:
+            # Flexible array member
+            try:
+                struct.insertAtOffset(field["offset"], fieldType, 0, field["name"], None)
+            except Exception:
+                # Older Ghidra versions don't support zero-length components
+                print(
+                    "Skipped flexible array member {}.{}".format(
+                        composite["name"], field["name"]
+                    )
+                )
+
+
+def fillUnion(union, composite):
+    for field in composite["fields"]:
+        fieldType = resolve(field["type"])
+        if "bit_size" in field:
+            union.addBitField(fieldType, field["bit_size"], field["name"], None)
+        else:
+            union.add(fieldType, fieldType.getLength(), field["name"], None)
+    if composite["size"] == 0:
+        return
+    # Drop the placeholder that gave the union its size, unless the union is
+    # padded beyond its largest member
+    placeholder = union.getComponent(0)
+    if all(
+        c.getLength() < placeholder.getLength()
+        for c in list(union.getComponents())[1:]
+    ):
+        placeholder.setFieldName("padding")
+    else:
+        union.delete(0)
+
+
+jythonFile = askFile("Select type dump JSON file", "Import")
+with open(jythonFile.absolutePath, "r") as f:
+    dump = json.load(f)
+
+monitor.setMessage("Importing {} types".format(dump["version"]))
+
+for enum in dump["enums"]:
+    enumType = EnumDataType(CATEGORY, enum["name"], enum["size"], dtm)
+    for name, value in enum["values"]:
+        enumType.add(name, value)
+    types[enum["name"]] = addType(enumType)
+
+# Composites can refer to each other (and to typedefs) in any order, so first
+# add them with the right sizes but no fields, then fill them in once every
+# type exists
+for composite in dump["composites"]:
+    if composite["kind"] == "union":
+        placeholder = UnionDataType(CATEGORY, composite["name"], dtm)
+        if composite["size"] > 0:
+            placeholder.add(
+                ArrayDataType(Undefined1DataType.dataType, composite["size"], 1, dtm),
+                composite["size"],
+                None,
+                None,
+            )
+    else:
+        placeholder = StructureDataType(
+            CATEGORY, composite["name"], composite["size"], dtm
+        )
+    types[composite["name"]] = addType(placeholder)
+
+for typedef in dump["typedefs"]:
+    types[typedef["name"]] = addType(
+        TypedefDataType(CATEGORY, typedef["name"], resolve(typedef["type"]), dtm)
+    )
+
+for composite in dump["composites"]:
+    monitor.checkCanceled()
+    if composite["kind"] == "union":
+        fillUnion(types[composite["name"]], composite)
+    else:
+        fillStruct(types[composite["name"]], composite)
+
+print(
+    "Imported {} enums, {} structs and unions, and {} typedefs for {}".format(
+        len(dump["enums"]),
+        len(dump["composites"]),
+        len(dump["typedefs"]),
+        dump["version"],
+    )
+)
@@ -14,15 +14,27 @@ conversions will be listed. If no binary files are provided and only absolute
 offsets are given, all possible binary files will be considered. If any of the
 input offsets are relative, an explicit list of binary files must be provided.
 
+With --stdin, offsets are read from standard input, one per line, and the
+conversions are written to standard output one per line, in the same order.
+This is meant for converting large numbers of offsets at once (e.g., addresses
+from an emulator trace log), since the binary ranges are only indexed once.
+Lines that can't be converted (e.g., lines that aren't numbers, or relative
+offsets without an explicit list of binary files) are written to the output as
+"<line>: error: <reason>", so the output still lines up with the input, and
+the exit status is nonzero. --stdin can't be combined with offset arguments.
+
 Example usage:
 python3 offsets.py 0x2010000 0x22DC260
 python3 offsets.py -b arm9 -b overlay29 0x2010000 0x22DC260
 python3 offsets.py -v EU -b overlay29 0x22DCBA0
 python3 offsets.py -b arm9 0x100 0x200 0x2010000
+python3 offsets.py --stdin < addresses.txt
 """
 
 import argparse
-from typing import List, Optional, Union
+import bisect
+import sys
+from typing import Iterable, List, Optional, Tuple, Union
 
 
 class Binary:
@@ -198,6 +210,33 @@ BINARY_NAMES = sorted(
 )
 
 
+class IntervalTable:
+    """A lookup table for the (possibly overlapping) ranges containing a point.
+
+    The ranges are split into disjoint segments at every range boundary, and
+    each segment stores the indexes of the ranges covering it, so a lookup is
+    a single binary search.
+    """
+
+    def __init__(self, ranges: List[Tuple[int, int]]):
+        self.bounds = sorted({x for r in ranges for x in r})
+        # self.covering[i] holds the ranges covering [bounds[i], bounds[i + 1])
+        self.covering: List[List[int]] = [[] for _ in self.bounds]
+        for i, (start, end) in enumerate(ranges):
+            for j in range(
+                bisect.bisect_left(self.bounds, start),
+                bisect.bisect_left(self.bounds, end),
+            ):
+                self.covering[j].append(i)
+
+    def lookup(self, point: int) -> List[int]:
+        """Get the indexes of the ranges containing a point, in ascending order."""
+        i = bisect.bisect_right(self.bounds, point) - 1
+        if i < 0:
+            return []
+        return self.covering[i]
+
+
 class OffsetMapping:
     """A mapping from some relative/absolute offset to a list of complementary offsets"""
 
@@ -230,70 +269,122 @@ class OffsetMapping:
         return s
 
 
-def convert_offsets(
-    version: str, bin_names: Optional[List[str]], offsets: List[int]
-) -> List[OffsetMapping]:
-    """Convert a list of offsets from absolute to relative or vice versa.
+class OffsetConverter:
+    """Converts offsets from absolute to relative or vice versa for a set of binaries.
 
-    Args:
-        version (str): game version
-        bin_names (Optional[List[str]]): list of binary file names to consider
-        offsets (List[int]): list of offsets to convert
-
-    Raises:
-        ValueError: invalid offsets
-
-    Returns:
-        List[OffsetMapping]: list of conversions for each input offset
+    The binary ranges are indexed once on construction, so converting many
+    offsets with the same converter is fast.
     """
 
-    local_bin_map = BINARIES[version]
+    def __init__(self, version: str, bin_names: Optional[List[str]]):
+        """
+        Args:
+            version (str): game version
+            bin_names (Optional[List[str]]): list of binary file names to consider
+        """
+        local_bin_map = BINARIES[version]
+
+        # All binaries have lengths far smaller than their load addresses,
+        # which makes inference simple
+        self.min_bin_addr = min([b.address for b in local_bin_map.values()])
+        self.max_bin_len = max([b.length for b in local_bin_map.values()])
+        assert self.min_bin_addr > self.max_bin_len
+
+        self.bin_names = bin_names
+        self.selected_binaries = [
+            (bname, b)
+            for bname, b in local_bin_map.items()
+            if bin_names is None or bname in set(bin_names)
+        ]
+        self.absolute_table = IntervalTable(
+            [(b.address, b.address + b.length) for _, b in self.selected_binaries]
+        )
+        self.relative_table = IntervalTable(
+            [
+                (b.file_offset, b.file_offset + b.length)
+                for _, b in self.selected_binaries
+            ]
+        )
 
-    # All binaries have lengths far smaller than their load addresses,
-    # which makes inference simple
-    min_bin_addr = min([b.address for b in local_bin_map.values()])
-    max_bin_len = max([b.length for b in local_bin_map.values()])
-    assert min_bin_addr > max_bin_len
+    def convert(self, offset: int) -> OffsetMapping:
+        """Convert a single offset.
 
-    selected_binaries = {
-        bname: b
-        for bname, b in local_bin_map.items()
-        if bin_names is None or bname in set(bin_names)
-    }
+        Raises:
+            ValueError: invalid offset
 
-    offset_mappings: List[OffsetMapping] = []
-    for offset in offsets:
+        Returns:
+            OffsetMapping: conversions for the input offset
+        """
         if offset < 0:
             raise ValueError(f"negative offset -0x{abs(offset):X} is invalid")
 
         # By the above assert, is_relative and is_absolute are mutually exclusive
-        is_relative = offset < max_bin_len
-        is_absolute = offset >= min_bin_addr
-        if is_relative and bin_names is None:
+        is_relative = offset < self.max_bin_len
+        is_absolute = offset >= self.min_bin_addr
+        if is_relative and self.bin_names is None:
             raise ValueError(
                 f"no binary specified, cannot interpret relative offset 0x{offset:X}"
             )
 
         # Do the offset conversion with any matching binaries
         mapping = OffsetMapping(offset, is_relative, is_absolute)
-        for bname, b in selected_binaries.items():
+        if is_relative:
+            matches = self.relative_table.lookup(offset)
+        elif is_absolute:
+            matches = self.absolute_table.lookup(offset)
+        else:
+            matches = []
+        for i in matches:
+            bname, b = self.selected_binaries[i]
+            val = b.absolute(offset) if is_relative else b.relative(offset)
+            if len(self.selected_binaries) == 1:
+                mapping.add(val)
+            else:
+                mapping.add(val, bname)
+        return mapping
 
-            def add_to_mapping(val):
-                if len(selected_binaries) == 1:
-                    mapping.add(val)
-                else:
-                    mapping.add(val, bname)
 
-            try:
-                if is_relative:
-                    add_to_mapping(b.absolute(offset))
-                elif is_absolute:
-                    add_to_mapping(b.relative(offset))
-            except ValueError:
-                continue
-        offset_mappings.append(mapping)
+def convert_offsets(
+    version: str, bin_names: Optional[List[str]], offsets: Iterable[int]
+) -> List[OffsetMapping]:
+    """Convert a list of offsets from absolute to relative or vice versa.
+
+    Args:
+        version (str): game version
+        bin_names (Optional[List[str]]): list of binary file names to consider
+        offsets (Iterable[int]): offsets to convert
+
+    Raises:
+        ValueError: invalid offsets
 
-    return offset_mappings
+    Returns:
+        List[OffsetMapping]: list of conversions for each input offset
+    """
+    converter = OffsetConverter(version, bin_names)
+    return [converter.convert(offset) for offset in offsets]
+
+
+def convert_lines(
+    converter: OffsetConverter, lines: Iterable[str]
+) -> Iterable[Tuple[str, bool]]:
+    """Convert offsets from lines of text, one per line. Blank lines are skipped.
+
+    Each input line yields one output line, along with whether the conversion
+    succeeded. If it failed, the output line is an error message for that line.
+    """
+    for line in lines:
+        line = line.strip()
+        if not line:
+            continue
+        try:
+            offset = int(line, 0)
+        except ValueError:
+            yield f"{line}: error: not an offset", False
+            continue
+        try:
+            yield str(converter.convert(offset)), True
+        except ValueError as e:
+            yield f"{line}: error: {e}", False
 
 
 if __name__ == "__main__":
@@ -321,8 +412,24 @@ if __name__ == "__main__":
         type=lambda x: int(x, 0),
         help="offset to convert (supports prefixed code literals, e.g., 0xff)",
     )
+    parser.add_argument(
+        "--stdin",
+        action="store_true",
+        help="read offsets from stdin (one per line) and print one conversion per line",
+    )
     args = parser.parse_args()
 
+    if args.stdin:
+        if args.offset:
+            parser.error("offset arguments can't be combined with --stdin")
+        converter = OffsetConverter(args.version, args.binary)
+        out = sys.stdout
+        failed = False
+        for result, ok in convert_lines(converter, sys.stdin):
+            failed = failed or not ok
+            out.write(f"{result}\n")
+        sys.exit(1 if failed else 0)
+
     offset_mappings = convert_offsets(args.version, args.binary, args.offset)
 
     print(f"Version: {args.version}")
@@ -0,0 +1,210 @@
+#!/usr/bin/env python3
+
+"""
+`packfile.py` is a command line utility and Python module for reading EoS Pack
+archives (the .bin files listed in PACK_FILE_PATHS_TABLE, such as
+MONSTER/monster.bin) without copying their contents.
+
+A Pack archive starts with a header of two 32-bit little-endian integers: a
+field that is always zero, followed by the number of files in the archive.
+The header is followed by a table of contents with one (offset, length) pair of
+32-bit little-endian integers per file, where the offset is relative to the
+start of the archive. This is the same layout that the game loads into
+`struct pack_file_opened` and `struct pack_file_table_of_content`.
+
+When used as a module, `PackArchive` memory-maps an archive and parses its
+table of contents once, up front. Individual files are then returned as
+`memoryview` slices of the mapping, so reading a file doesn't copy any data.
+`PackIndex` opens the archives of an unpacked ROM directory on demand, keyed by
+the values of `enum pack_file_id`. Note that an archive can't be closed while
+views into it are still alive.
+
+The command line interface can list the table of contents of an archive,
+extract its files, or time the memory-mapped read path against reading each
+file with a separate seek() and read().
+
+Example usage:
+python3 packfile.py list </path/to/EoS_NA_unpacked_dir>/data/MONSTER/monster.bin
+python3 packfile.py extract -o out </path/to/monster.bin>
+python3 packfile.py bench </path/to/monster.bin>
+"""
+
+import argparse
+import mmap
+import os
+import struct
+import time
+from pathlib import Path
+from typing import Dict, List, Tuple, Union
+
+# Paths of the Pack archives in the ROM filesystem, indexed by enum pack_file_id.
+PACK_FILE_PATHS = [
+    "MONSTER/monster.bin",  # PACK_ARCHIVE_MONSTER
+    "MONSTER/m_attack.bin",  # PACK_ARCHIVE_M_ATTACK
+    "MONSTER/m_ground.bin",  # PACK_ARCHIVE_M_GROUND
+    "EFFECT/effect.bin",  # PACK_ARCHIVE_EFFECT
+    "DUNGEON/dungeon.bin",  # PACK_ARCHIVE_DUNGEON
+    "BALANCE/m_level.bin",  # PACK_ARCHIVE_M_LEVEL
+]
+
+HEADER = struct.Struct("<II")
+TOC_ENTRY = struct.Struct("<II")
+
+
+class PackArchive:
+    """A memory-mapped Pack archive"""
+
+    def __init__(self, path: Union[str, Path]):
+        self.path = Path(path)
+        with open(self.path, "rb") as f:
+            # The mapping stays valid after the file is closed
+            self._mmap = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+        self._view = memoryview(self._mmap)
+        try:
+            self.toc = self._read_toc()
+        except Exception:
+            self.close()
+            raise
+
+    def _read_toc(self) -> List[Tuple[int, int]]:
+        if len(self._mmap) < HEADER.size:
+            raise ValueError(f"{self.path}: file is too small to be a Pack archive")
+        _, count = HEADER.unpack_from(self._mmap, 0)
+        toc_end = HEADER.size + count * TOC_ENTRY.size
+        if toc_end > len(self._mmap):
+            raise ValueError(f"{self.path}: table of contents is out of bounds")
+        toc = list(TOC_ENTRY.iter_unpack(self._view[HEADER.size : toc_end]))
+        for i, (offset, length) in enumerate(toc):
+            if offset + length > len(self._mmap):
+                raise ValueError(f"{self.path}: file {i} is out of bounds")
+        return toc
+
+    def __len__(self) -> int:
+        return len(self.toc)
+
+    def __getitem__(self, index: int) -> memoryview:
+        """Returns a read-only view of the file at the given index, without copying"""
+        offset, length = self.toc[index]
+        return self._view[offset : offset + length]
+
+    def close(self):
+        self._view.release()
+        self._mmap.close()
+
+    def __enter__(self) -> "PackArchive":
+        return self
+
+    def __exit__(self, *args):
+        self.close()
+
+
+class PackIndex:
+    """Lazily opened Pack archives of an unpacked ROM, keyed by enum pack_file_id"""
+
+    def __init__(self, data_dir: Union[str, Path]):
+        self.data_dir = Path(data_dir)
+        self._archives: Dict[int, PackArchive] = {}
+
+    def archive(self, pack_id: int) -> PackArchive:
+        if pack_id not in self._archives:
+            path = self.data_dir / PACK_FILE_PATHS[pack_id]
+            self._archives[pack_id] = PackArchive(path)
+        return self._archives[pack_id]
+
+    def get(self, pack_id: int, file_index: int) -> memoryview:
+        """Returns a read-only view of a file in a Pack archive, without copying"""
+        return self.archive(pack_id)[file_index]
+
+    def close(self):
+        for archive in self._archives.values():
+            archive.close()
+        self._archives.clear()
+
+    def __enter__(self) -> "PackIndex":
+        return self
+
+    def __exit__(self, *args):
+        self.close()
+
+
+def cmd_list(args: argparse.Namespace):
+    with PackArchive(args.file) as pack:
+        for i, (offset, length) in enumerate(pack.toc):
+            print(f"{i:5}: offset=0x{offset:08X} length=0x{length:X}")
+
+
+def cmd_extract(args: argparse.Namespace):
+    output_dir = Path(args.output_dir)
+    output_dir.mkdir(parents=True, exist_ok=True)
+    with PackArchive(args.file) as pack:
+        width = len(str(len(pack) - 1)) if len(pack) > 0 else 1
+        for i in range(len(pack)):
+            view = pack[i]
+            with open(output_dir / f"{i:0{width}}.bin", "wb") as f:
+                f.write(view)
+            view.release()
+
+
+def cmd_bench(args: argparse.Namespace):
+    def time_passes(read_all) -> float:
+        best = float("inf")
+        for _ in range(args.passes):
+            start = time.perf_counter()
+            read_all()
+            best = min(best, time.perf_counter() - start)
+        return best
+
+    def naive():
+        # Reparse the table of contents and copy each file into its own buffer
+        with open(args.file, "rb") as f:
+            _, count = HEADER.unpack(f.read(HEADER.size))
+            toc = list(TOC_ENTRY.iter_unpack(f.read(count * TOC_ENTRY.size)))
+            for offset, length in toc:
+                f.seek(offset)
+                f.read(length)
+
+    with PackArchive(args.file) as pack:
+
+        def mapped():
+            for i in range(len(pack)):
+                pack[i].release()
+
+        total = sum(length for _, length in pack.toc)
+        print(f"{len(pack)} files, {total} bytes, best of {args.passes} passes")
+        for name, read_all in [("read", naive), ("mmap", mapped)]:
+            elapsed = time_passes(read_all)
+            print(f"{name:>5}: {elapsed * 1000:.3f} ms")
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Read EoS Pack archives without copying their contents"
+    )
+    subparsers = parser.add_subparsers(dest="command", required=True)
+
+    parser_list = subparsers.add_parser("list", help="list the table of contents")
+    parser_list.add_argument("file", help="Pack archive file")
+    parser_list.set_defaults(func=cmd_list)
+
+    parser_extract = subparsers.add_parser("extract", help="extract all files")
+    parser_extract.add_argument("file", help="Pack archive file")
+    parser_extract.add_argument(
+        "-o", "--output-dir", default=os.curdir, help="output directory"
+    )
+    parser_extract.set_defaults(func=cmd_extract)
+
+    parser_bench = subparsers.add_parser(
+        "bench", help="compare memory-mapped reads against copying reads"
+    )
+    parser_bench.add_argument("file", help="Pack archive file")
+    parser_bench.add_argument(
+        "-n", "--passes", type=int, default=5, help="number of timed passes"
+    )
+    parser_bench.set_defaults(func=cmd_bench)
+
+    args = parser.parse_args()
+    args.func(args)
+
+
+if __name__ == "__main__":
+    main()
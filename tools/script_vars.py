@@ -0,0 +1,163 @@
+#!/usr/bin/env python3
+
+"""
+`script_vars.py` is a command line utility that generates a C header with
+precomputed access information for every EoS script variable, read from the
+SCRIPT_VARS and SCRIPT_VARS_LOCALS tables of an ARM9 binary.
+
+The script engine looks up a `struct script_var` and resolves its location on
+every variable access (see LoadScriptVariableRaw). The generated header resolves
+this information ahead of time. For each variable stored in memory, it defines:
+    - SCRIPT_VAR_<NAME>_OFFSET: the byte offset of the value, into
+      `struct script_var_value_table` for global variables, or into the local
+      variable table for local variables
+    - SCRIPT_VAR_<NAME>_BIT: the bit position of the first value within the
+      byte at the offset (always 0 unless the type is VARTYPE_BIT)
+    - SCRIPT_VAR_<NAME>_WIDTH: the width of each value, in bits
+    - SCRIPT_VAR_<NAME>_COUNT: the number of values (more than 1 for arrays)
+    - SCRIPT_VAR_<NAME>_SIGNED: whether the values are signed
+
+Values of an array variable are packed contiguously. For a variable of type
+VARTYPE_BIT, value i is stored in bit ((BIT + i) % 8) of the byte at
+(OFFSET + (BIT + i) / 8). For other types, value i is stored at
+(OFFSET + i * WIDTH / 8). Variables of type VARTYPE_NONE and VARTYPE_SPECIAL
+aren't stored in memory and are skipped.
+
+The table addresses are read from the pmdsky-debug symbol tables (see
+binary_tables.py).
+
+Example usage:
+python3 script_vars.py </path/to/EoS_NA_unpacked_dir>/arm9.bin > script_vars.h
+python3 script_vars.py -v EU -o script_vars_eu.h </path/to/arm9.bin>
+"""
+
+import argparse
+from enum import IntEnum
+import struct
+import sys
+from typing import List, NamedTuple, TextIO
+
+from binary_tables import BinaryFile
+
+# Script variable IDs of local variables start at VAR_LOCAL0
+LOCAL_VAR_ID_START = 0x400
+
+
+class ScriptVarType(IntEnum):
+    """Same as enum script_var_type"""
+
+    NONE = 0
+    BIT = 1
+    STRING = 2
+    UINT8 = 3
+    INT8 = 4
+    UINT16 = 5
+    INT16 = 6
+    UINT32 = 7
+    INT32 = 8
+    SPECIAL = 9
+
+
+# (width in bits, signed) for each type that is stored in memory
+TYPE_LAYOUTS = {
+    ScriptVarType.BIT: (1, False),
+    ScriptVarType.STRING: (8, False),
+    ScriptVarType.UINT8: (8, False),
+    ScriptVarType.INT8: (8, True),
+    ScriptVarType.UINT16: (16, False),
+    ScriptVarType.INT16: (16, True),
+    ScriptVarType.UINT32: (32, False),
+    ScriptVarType.INT32: (32, True),
+}
+
+# Layout of struct script_var
+SCRIPT_VAR = struct.Struct("<HHHHHhI")
+
+
+class ScriptVar(NamedTuple):
+    id: int
+    name: str
+    type: ScriptVarType
+    mem_offset: int
+    bitshift: int
+    n_values: int
+
+
+def read_table(
+    arm9: BinaryFile, address: int, n_entries: int, first_id: int
+) -> List[ScriptVar]:
+    data = arm9.read(address, n_entries * SCRIPT_VAR.size)
+    table = []
+    for i, entry in enumerate(SCRIPT_VAR.iter_unpack(data)):
+        vtype, _, mem_offset, bitshift, n_values, _, name_ptr = entry
+        table.append(
+            ScriptVar(
+                first_id + i,
+                arm9.read_cstring(name_ptr),
+                ScriptVarType(vtype),
+                mem_offset,
+                bitshift,
+                n_values,
+            )
+        )
+    return table
+
+
+def write_header(out: TextIO, version: str, script_vars: List[ScriptVar]):
+    guard = f"SCRIPT_VARS_{version}_H_"
+    out.write(
+        f"// Generated by script_vars.py from the {version} ARM9 binary. Do not edit.\n"
+        "// See script_vars.py for how to interpret these definitions.\n\n"
+        f"#ifndef {guard}\n#define {guard}\n"
+    )
+    for var in script_vars:
+        if var.type not in TYPE_LAYOUTS:
+            continue
+        width, signed = TYPE_LAYOUTS[var.type]
+        bit = var.bitshift if var.type == ScriptVarType.BIT else 0
+        prefix = f"SCRIPT_VAR_{var.name.upper()}"
+        out.write(
+            f"\n// ID 0x{var.id:X}, {var.type.name}\n"
+            f"#define {prefix}_OFFSET 0x{var.mem_offset:X}\n"
+            f"#define {prefix}_BIT {bit}\n"
+            f"#define {prefix}_WIDTH {width}\n"
+            f"#define {prefix}_COUNT {var.n_values}\n"
+            f"#define {prefix}_SIGNED {int(signed)}\n"
+        )
+    out.write(f"\n#endif // {guard}\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Generate a C header of precomputed EoS script variable locations"
+    )
+    parser.add_argument(
+        "-v",
+        "--version",
+        choices=["NA", "EU", "JP"],
+        type=str.upper,
+        default="NA",
+        help="EoS version",
+    )
+    parser.add_argument(
+        "-o", "--output", help="output header file (default: standard output)"
+    )
+    parser.add_argument("arm9", help="ARM9 binary file (arm9.bin)")
+    args = parser.parse_args()
+
+    arm9 = BinaryFile(args.arm9, args.version, "arm9")
+    global_vars = read_table(arm9, arm9.table_address("SCRIPT_VARS"), 115, 0)
+    local_vars = read_table(
+        arm9, arm9.table_address("SCRIPT_VARS_LOCALS"), 4, LOCAL_VAR_ID_START
+    )
+    script_vars = global_vars + local_vars
+
+    if args.output is None:
+        write_header(sys.stdout, args.version, script_vars)
+    else:
+        with open(args.output, "w") as f:
+            write_header(f, args.version, script_vars)
+
+
+if __name__ == "__main__":
+    main()
@@ -42,6 +42,14 @@ successful completion of the program. However, this may leave the symbol table
 files in a bad state if the program is terminated prematurely (such as from a
 user interrupt).
 
+For filling whole symbol tables, batch mode (--batch) is much faster still.
+Each binary is loaded and indexed once, and every search uses the index
+rather than scanning the binary again. All filled addresses are written back
+in one go at the end, followed by a single formatter run. Unlike the normal
+mode, batch mode only finds matches at word-aligned offsets (which is where ARM
+functions are), so it can occasionally fill an address that the normal mode
+would consider ambiguous because of a spurious unaligned match.
+
 This program requires cargo to be installed and available in the runtime
 environment so that `resymgen` can be run.
 
@@ -51,6 +59,10 @@ python3 symbols_vfill.py -f \
     --dir-na </path/to/EoS_NA_unpacked_dir> \
     --dir-eu </path/to/EoS_EU_unpacked_dir>
 
+python3 symbols_vfill.py --batch \
+    --dir-na </path/to/EoS_NA_unpacked_dir> \
+    --dir-eu </path/to/EoS_EU_unpacked_dir>
+
 python3 symbols_vfill.py -f --dry-run \
     --dir-na </path/to/EoS_NA_unpacked_dir> \
     --dir-eu </path/to/EoS_EU_unpacked_dir>
@@ -58,7 +70,6 @@ python3 symbols_vfill.py -f --dry-run \
 
 import argparse
 from pathlib import Path
-import re
 import subprocess
 import sys
 from typing import Dict, Generator, Iterable, List, NamedTuple, Optional, Tuple, Union
@@ -96,6 +107,10 @@ DEPENDENT_VERSIONS = [
     DependentVersion("WRAM", ".wram", "-WRAM"),
     DependentVersion("RAM", ".ram", "-RAM"),
 ]
+# Use the LibYAML bindings if they're available, since they're much faster
+YAML_LOADER = getattr(yaml, "CSafeLoader", yaml.SafeLoader)
+YAML_DUMPER = getattr(yaml, "CSafeDumper", yaml.SafeDumper)
+
 REAL_BINARY_NAMES = [
     b
     for b in offsets.BINARY_NAMES
@@ -139,11 +154,11 @@ class SymbolTable:
 
     def read(self) -> dict:
         with self.path.open("r") as f:
-            return yaml.safe_load(f)
+            return yaml.load(f, Loader=YAML_LOADER)
 
     def write(self, symbols: dict, *, skip_formatting: bool = False):
         with self.path.open("w") as f:
-            yaml.safe_dump(symbols, f)
+            yaml.dump(symbols, f, Dumper=YAML_DUMPER)
 
         if not skip_formatting:
             # It's slower to do formatting here, one file at a time rather than
@@ -278,6 +293,7 @@ def function_fill_versions(
     *,
     min_instr_count: int = 4,
     addr_bounds: Optional[Dict[str, AddressBounds]] = None,
+    word_index_cache: Optional[Dict[str, arm5find.WordIndex]] = None,
     verbosity: int = 0,
     dry_run: bool = False,
 ) -> FillCounter:
@@ -293,6 +309,11 @@ def function_fill_versions(
             length search. Defaults to 4.
         addr_bounds (Optional[Dict[str, AddressBounds]], optional): per-version
             bounds on inferred addresses. Defaults to None.
+        word_index_cache (Optional[Dict[str, arm5find.WordIndex]], optional):
+            binary file word indexes by game version, can be mutated. If
+            provided, searches are done with the indexes (which only find
+            word-aligned matches) rather than by scanning the binary files.
+            Defaults to None.
         verbosity (int, optional): verbosity (0-4). Defaults to 0.
         dry_run (bool, optional): enable dry run mode. Defaults to False.
 
@@ -366,21 +387,29 @@ def function_fill_versions(
     for dst_vers in missing:
         log_prefix = f"[{bin_name}, {dst_vers}] {function['name']}: "
 
-        if dst_vers not in file_contents_cache:
-            # Read the binary file for the first time and cache it
-            with open(file_by_version[dst_vers], "rb") as f:
-                file_contents_cache[dst_vers] = f.read()
+        for vers in (src_vers, dst_vers):
+            if vers not in file_contents_cache:
+                # Read the binary file for the first time and cache it
+                with open(file_by_version[vers], "rb") as f:
+                    file_contents_cache[vers] = f.read()
         contents = file_contents_cache[dst_vers]
+        if word_index_cache is not None and dst_vers not in word_index_cache:
+            # Index the binary file for the first time and cache it
+            word_index_cache[dst_vers] = arm5find.WordIndex(contents)
 
         # Search for a single match. If there are multiple simultaneous
         # matches, the search was too permissive and the results don't count
-        match: Optional[re.Match] = None
+        match: Optional[int] = None
 
-        def single_search(fn_len: int) -> List[re.Match]:
+        def single_search(fn_len: int) -> List[int]:
+            """Returns the offsets of all matches"""
+            if word_index_cache is not None:
+                raw = file_contents_cache[src_vers][relative : relative + fn_len]
+                return word_index_cache[dst_vers].find_asm(raw)
             segment = arm5find.AsmSegment(relative, fn_len)
             with open(file_by_version[src_vers], "rb") as f:
                 regex = segment.regex(f)
-                return list(regex.finditer(contents))
+                return [m.start() for m in regex.finditer(contents)]
 
         search_results = single_search(length)
         if adaptive_length:
@@ -463,7 +492,7 @@ def function_fill_versions(
 
         if match is not None:
             # Convert back to absolute address
-            match_addr = offsets.convert_offsets(dst_vers, [bin_name], [match.start()])[
+            match_addr = offsets.convert_offsets(dst_vers, [bin_name], [match])[
                 0
             ].get_mapped()[0]
 
@@ -490,7 +519,7 @@ def function_fill_versions(
             for dep_vers in dep_versions:
                 # Convert to the dependent version's absolute address
                 dep_mappings = offsets.convert_offsets(
-                    dst_vers, [dep_vers.convert_binary(bin_name)], [match.start()]
+                    dst_vers, [dep_vers.convert_binary(bin_name)], [match]
                 )
                 # Do the check regardless of whether or not we end up adding
                 if not dep_mappings:
@@ -536,6 +565,7 @@ def symbols_fill_versions(
     verbosity: int = 0,
     dry_run: bool = False,
     fast_mode: bool = False,
+    batch_mode: bool = False,
 ) -> Dict[str, FillCounter]:
     """Fill in addresses for missing versions within the symbol tables.
 
@@ -549,6 +579,7 @@ def symbols_fill_versions(
         verbosity (int, optional): verbosity (0-4). Defaults to 0.
         dry_run (bool, optional): enable dry run mode. Defaults to False.
         fast_mode (bool, optional): enable fast mode. Defaults to False.
+        batch_mode (bool, optional): enable batch mode. Defaults to False.
 
     Returns:
         Dict[str, FillCounter]: statistics from the filling process, by binary
@@ -556,10 +587,17 @@ def symbols_fill_versions(
     # Counters by binary for reporting
     counters: Dict[str, FillCounter] = {}
     files_to_format: List[str] = []  # Only used in fast mode
+    # Only used in batch mode
+    pending_writes: List[Tuple[SymbolTable, dict]] = []
 
     for bin_name, file_by_version in binaries.items():
         # Keep a cache of file contents by version to avoid loading them many times
         binary_contents: Dict[str, bytes] = {}
+        # In batch mode, also keep a cache of indexes of the file contents, so
+        # every search doesn't have to scan an entire file
+        word_indexes: Optional[Dict[str, arm5find.WordIndex]] = (
+            {} if batch_mode else None
+        )
 
         counters[bin_name] = FillCounter()
 
@@ -592,18 +630,27 @@ def symbols_fill_versions(
                         bin_name,
                         min_instr_count=min_instr_count,
                         addr_bounds=addr_bounds,
+                        word_index_cache=word_indexes,
                         verbosity=verbosity,
                         dry_run=dry_run,
                     )
 
             # The symbol table is modified iff the filled counter is positive
             if not dry_run and table_counter.filled > 0:
-                symbol_table.write(symbol_contents, skip_formatting=fast_mode)
-                if fast_mode:
-                    # We'll need to run the formatter on this later
-                    files_to_format.append(str(symbol_table.path))
+                if batch_mode:
+                    # Write everything back at the end
+                    pending_writes.append((symbol_table, symbol_contents))
+                else:
+                    symbol_table.write(symbol_contents, skip_formatting=fast_mode)
+                    if fast_mode:
+                        # We'll need to run the formatter on this later
+                        files_to_format.append(str(symbol_table.path))
             counters[bin_name] += table_counter
 
+    for symbol_table, symbol_contents in pending_writes:
+        symbol_table.write(symbol_contents, skip_formatting=True)
+        files_to_format.append(str(symbol_table.path))
+
     if files_to_format:
         SymbolTable.fmt(files_to_format)
 
@@ -652,6 +699,14 @@ if __name__ == "__main__":
         help=f"{Path(__file__).name} in fast mode will run faster,"
         + " but might leave files in a bad state upon premature termination",
     )
+    parser.add_argument(
+        "-B",
+        "--batch",
+        action="store_true",
+        help="batch mode: index each binary once for all searches (only"
+        + " finding word-aligned matches), and write back all filled addresses"
+        + " at the end (like fast mode)",
+    )
     args = parser.parse_args()
 
     if not args.binary:
@@ -684,6 +739,7 @@ if __name__ == "__main__":
         verbosity=args.verbose,
         dry_run=args.dry_run,
         fast_mode=args.fast,
+        batch_mode=args.batch,
     )
     total_counter = FillCounter()
     for counter in counters.values():
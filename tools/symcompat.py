@@ -56,10 +56,15 @@ def print_help_text():
 
 
 def check_symbol_compatibility(
-    path: Path, base: str, target: Optional[str], *, show_help_text: bool = False
+    path: Path,
+    base: str,
+    target: Optional[str],
+    *,
+    show_help_text: bool = False,
+    file_cache: Optional[symdiff.SymbolFileCache] = None,
 ) -> bool:
-    old_table = symdiff.SymbolTable(path, revision=base)
-    new_table = symdiff.SymbolTable(path, revision=target)
+    old_table = symdiff.SymbolTable(path, revision=base, file_cache=file_cache)
+    new_table = symdiff.SymbolTable(path, revision=target, file_cache=file_cache)
     if not old_table.valid and not new_table.valid:
         return True
 
@@ -106,6 +111,7 @@ if __name__ == "__main__":
         help="print an extended warning message for compatibility issues",
     )
     args = symdiff.symdiff_parse_args(parser)
+    file_cache = symdiff.symbol_file_cache(args)
 
     compat_issues = False
     for path in args.path:
@@ -114,6 +120,7 @@ if __name__ == "__main__":
             args.base,
             args.target,
             show_help_text=args.warn and not compat_issues,
+            file_cache=file_cache,
         )
     if compat_issues:
         raise SystemExit(1)
@@ -25,21 +25,30 @@ moved between subregions but kept within the same top-level block. These
 changes can be included in the diff with the `--descriptions` and
 `--subregion-resolution` flags, respectively.
 
+When comparing many symbol tables (e.g., across releases), the `--batch` flag
+loads all the needed files up front through a single `git cat-file --batch`
+process instead of one `git show` per file, and `--jobs` can additionally
+spread YAML parsing across multiple worker processes.
+
 Example usage:
 
 python3 symdiff.py
 python3 symdiff.py HEAD~5 HEAD~2 -- </path/to/arm9.yml> </path/to/overlay29.yml>
 python3 symdiff.py -sdv <tag name, commit hash, or branch name>
+python3 symdiff.py -b -j 8 <base revision> <target revision>
 """
 
 import argparse
 import collections
+from concurrent.futures import ProcessPoolExecutor
 import difflib
 from io import StringIO
 from pathlib import Path
 import subprocess
 import sys
 from typing import (
+    Any,
+    BinaryIO,
     cast,
     Deque,
     Dict,
@@ -57,6 +66,8 @@ import ansi
 
 REPO_ROOT: Path = Path(__file__).resolve().parent.parent
 SYMBOL_DIR: Path = REPO_ROOT / "symbols"
+# Use the C YAML bindings for bulk parsing if available
+YAML_LOADER = getattr(yaml, "CSafeLoader", yaml.SafeLoader)
 
 
 def git_cmd(args: List[str]) -> str:
@@ -108,27 +119,41 @@ def ensure_revision_exists(revision: str):
         raise ValueError(e.stderr.decode())
 
 
-def open_file_at_revision(path: Path, revision: Optional[str]) -> TextIO:
-    """Read a file from the repository as it was at the given revision.
+def path_from_repo_root(path: Path) -> str:
+    """Get a path relative to the repository root, in the format used by git.
 
     Args:
         path (Path): path to file
-        revision (Optional[str]): git revision, or None for the working tree
 
     Raises:
         ValueError: file path is outside of the git repository
-        FileNotFoundError: file path does not exist for the given revision
 
     Returns:
-        TextIO: text stream for the given file
+        str: path relative to the repository root
     """
     # Git requires forward slashes, even on Windows.
     # Resolve paths to be relative to the repo root to make things easier.
     try:
-        path_from_root: str = path.resolve().relative_to(REPO_ROOT).as_posix()
+        return path.resolve().relative_to(REPO_ROOT).as_posix()
     except ValueError:
         raise ValueError(f"'{path}' is outside of git repository")
 
+
+def open_file_at_revision(path: Path, revision: Optional[str]) -> TextIO:
+    """Read a file from the repository as it was at the given revision.
+
+    Args:
+        path (Path): path to file
+        revision (Optional[str]): git revision, or None for the working tree
+
+    Raises:
+        ValueError: file path is outside of the git repository
+        FileNotFoundError: file path does not exist for the given revision
+
+    Returns:
+        TextIO: text stream for the given file
+    """
+    path_from_root = path_from_repo_root(path)
     if revision is None:
         return path.open("r")
 
@@ -141,6 +166,204 @@ def open_file_at_revision(path: Path, revision: Optional[str]) -> TextIO:
         raise FileNotFoundError(e.stderr.decode())
 
 
+def top_level_table(path_from_root: str) -> Optional[str]:
+    """
+    Get the path of the top-level symbol table that a symbol table file
+    belongs to, or None if the path isn't a symbol table file. Paths are
+    relative to the repository root.
+    """
+    path = Path(path_from_root)
+    if path.suffix != ".yml":
+        return None
+    try:
+        table = Path(path.relative_to("symbols").parts[0]).with_suffix(".yml")
+    except ValueError:
+        return None
+    return (Path("symbols") / table).as_posix()
+
+
+class GitBlobReader:
+    """
+    Reads files at arbitrary revisions through a single long-running
+    `git cat-file --batch` process, rather than spawning a new process for
+    each file.
+    """
+
+    def __init__(self):
+        self.proc = subprocess.Popen(
+            ["git", "-C", str(REPO_ROOT), "cat-file", "--batch"],
+            stdin=subprocess.PIPE,
+            stdout=subprocess.PIPE,
+        )
+
+    def __enter__(self) -> "GitBlobReader":
+        return self
+
+    def __exit__(self, *args):
+        self.close()
+
+    def close(self):
+        cast(BinaryIO, self.proc.stdin).close()
+        self.proc.wait()
+
+    def read(self, revision: str, path_from_root: str) -> Optional[bytes]:
+        """Read a file from the repository as it was at the given revision.
+
+        Args:
+            revision (str): git revision
+            path_from_root (str): path relative to the repository root, with
+                forward slashes
+
+        Returns:
+            Optional[bytes]: file contents, or None if the file doesn't exist
+                in the given revision
+        """
+        stdin = cast(BinaryIO, self.proc.stdin)
+        stdout = cast(BinaryIO, self.proc.stdout)
+        stdin.write(f"{revision}:{path_from_root}\n".encode())
+        stdin.flush()
+        # The header is "<object> <type> <size>" if the object exists, and
+        # "<object> missing" (or similar) otherwise
+        header = stdout.readline().split()
+        if len(header) != 3:
+            return None
+        contents = stdout.read(int(header[2]))
+        # Contents are followed by a newline
+        stdout.read(1)
+        return contents if header[1] == b"blob" else None
+
+
+def parse_yaml(contents: bytes) -> Any:
+    return yaml.load(contents, Loader=YAML_LOADER)
+
+
+class SymbolFileCache:
+    """
+    Parsed contents of symbol table files, loaded up front in bulk.
+
+    All the files belonging to each requested top-level table (i.e., the table
+    itself and its subregion files) are loaded for each requested revision.
+    Files from git revisions are streamed through a single `git cat-file
+    --batch` process, and parsing can be spread across a pool of worker
+    processes.
+    """
+
+    def __init__(
+        self,
+        paths: Iterable[Path],
+        revisions: Iterable[Optional[str]],
+        jobs: int = 1,
+    ):
+        """
+        Args:
+            paths (Iterable[Path]): paths to top-level symbol table files. Must
+                be within the pmdsky-debug repository.
+            revisions (Iterable[Optional[str]]): revisions, with None for the
+                working tree
+            jobs (int, optional): number of worker processes for parsing.
+                Defaults to 1, which parses in the current process.
+        """
+        tables = [path_from_repo_root(p) for p in paths]
+        # Top-level tables covered by the cache, as (revision, table path)
+        self.tables: Set[Tuple[Optional[str], str]] = set()
+        keys: List[Tuple[Optional[str], str]] = []
+        raw_contents: List[bytes] = []
+        with GitBlobReader() as reader:
+            # dict.fromkeys() dedups while preserving order
+            for revision in dict.fromkeys(revisions):
+                self.tables.update((revision, t) for t in tables)
+                for file in SymbolFileCache._list_files(tables, revision):
+                    if revision is None:
+                        contents: Optional[bytes] = (REPO_ROOT / file).read_bytes()
+                    else:
+                        contents = reader.read(revision, file)
+                    if contents is not None:
+                        keys.append((revision, file))
+                        raw_contents.append(contents)
+
+        if jobs > 1 and len(raw_contents) > 1:
+            with ProcessPoolExecutor(max_workers=jobs) as executor:
+                parsed = list(executor.map(parse_yaml, raw_contents))
+        else:
+            parsed = [parse_yaml(c) for c in raw_contents]
+        # {(revision, file path) -> parsed file contents}
+        self.contents: Dict[Tuple[Optional[str], str], Any] = dict(zip(keys, parsed))
+
+    @staticmethod
+    def _list_files(tables: List[str], revision: Optional[str]) -> List[str]:
+        """
+        List the files belonging to the given top-level tables in a revision.
+        """
+        files: List[str] = []
+        if revision is None:
+            for table in tables:
+                table_path = REPO_ROOT / table
+                if table_path.is_file():
+                    files.append(table)
+                files += sorted(
+                    p.relative_to(REPO_ROOT).as_posix()
+                    for p in table_path.with_suffix("").rglob("*.yml")
+                    if p.is_file()
+                )
+            return files
+        if not tables:
+            return files
+        prefixes: List[str] = []
+        for table in tables:
+            prefixes += [table, table[: -len(".yml")] + "/"]
+        listing = git_cmd(["ls-tree", "-r", "--name-only", revision, "--"] + prefixes)
+        return [f for f in listing.split("\n") if f.endswith(".yml")]
+
+    def load(self, path: Path, revision: Optional[str]) -> Any:
+        """Get the parsed contents of a file as it was at the given revision.
+
+        Files that aren't covered by the cache are read directly.
+
+        Args:
+            path (Path): path to file
+            revision (Optional[str]): git revision, or None for the working tree
+
+        Raises:
+            FileNotFoundError: file path does not exist for the given revision
+
+        Returns:
+            Any: parsed file contents
+        """
+        path_from_root = path_from_repo_root(path)
+        if (revision, top_level_table(path_from_root)) not in self.tables:
+            return load_file_at_revision(path, revision)
+        try:
+            return self.contents[(revision, path_from_root)]
+        except KeyError:
+            raise FileNotFoundError(
+                f"'{path_from_root}' does not exist in {revision_str(revision)}"
+            )
+
+
+def load_file_at_revision(
+    path: Path, revision: Optional[str], file_cache: Optional[SymbolFileCache] = None
+) -> Any:
+    """Parse a YAML file from the repository as it was at the given revision.
+
+    Args:
+        path (Path): path to file
+        revision (Optional[str]): git revision, or None for the working tree
+        file_cache (Optional[SymbolFileCache], optional): preloaded files to
+            read from, if any. Defaults to None.
+
+    Raises:
+        ValueError: file path is outside of the git repository
+        FileNotFoundError: file path does not exist for the given revision
+
+    Returns:
+        Any: parsed file contents
+    """
+    if file_cache is not None:
+        return file_cache.load(path, revision)
+    with open_file_at_revision(path, revision) as f:
+        return yaml.safe_load(f)
+
+
 class SymbolPath:
     """
     A fully qualified symbol identifier with a file path, block, and name.
@@ -498,23 +721,6 @@ class Symbol:
         )
 
 
-class MatchRank:
-    """
-    Represents the quality of the match between two symbols. Functions as a
-    tuple (# matching addresses, whether or not the names match).
-    """
-
-    def __init__(self, n_matches: int = 0, matching_name: bool = False):
-        self.n_matches = n_matches
-        self.matching_name = matching_name
-
-    def __repr__(self) -> str:
-        return repr(self.key())
-
-    def key(self) -> Tuple[int, bool]:
-        return (self.n_matches, self.matching_name)
-
-
 class SymbolList(list):
     """List of symbols from the pmdsky-debug symbol tables"""
 
@@ -533,6 +739,9 @@ class SymbolList(list):
         are tallied to assign each candidate match with a "match rank", which
         measures the quality of the match. The match rank for a symbol pair is
         defined as the tuple (# matching addresses, whether the names match).
+        Since only indexed lookups are done, building the graph takes time
+        roughly linear in the total number of addresses and candidate matches,
+        rather than comparing every pair of symbols.
 
         The collection of candidate matches are then grouped by match rank,
         and the groups are returned in descending order of rank.
@@ -558,31 +767,40 @@ class SymbolList(list):
                     base_addr_to_idx.setdefault((version, addr), []).append(i)
             base_name_to_idx.setdefault(s.name, []).append(i)
 
-        # Matches in base for each element in self, alongside a "match rank"
-        matches: List[Dict[int, MatchRank]] = [{} for _ in range(len(self))]
-        for s, match_list in zip(cast(List[Symbol], self), matches):
+        # Matches in base for each element in self, alongside the number of
+        # matching addresses. Symbols only matched by name have zero matching
+        # addresses. Dicts keep the order in which matches are first found,
+        # which determines the order of the neighbor lists in the graph.
+        matches: List[Dict[int, int]] = []
+        name_matches: List[Set[int]] = []
+        for s in cast(List[Symbol], self):
+            n_addr_matches: Dict[int, int] = {}
             for version, addrs in s.address.items():
                 for addr in addrs:
-                    for i_base in base_addr_to_idx.get((version, addr), []):
-                        match_list.setdefault(i_base, MatchRank()).n_matches += 1
-            for i_base in base_name_to_idx.get(s.name, []):
-                match_list.setdefault(i_base, MatchRank()).matching_name = True
+                    for i_base in base_addr_to_idx.get((version, addr), ()):
+                        n_addr_matches[i_base] = n_addr_matches.get(i_base, 0) + 1
+            same_name = base_name_to_idx.get(s.name, ())
+            for i_base in same_name:
+                n_addr_matches.setdefault(i_base, 0)
+            matches.append(n_addr_matches)
+            name_matches.append(set(same_name))
 
         # Aggregate the match list entries by match rank
         matches_by_rank: Dict[Tuple[int, bool], Dict[int, List[int]]] = {}
-        for i, mlist in enumerate(matches):
-            for m, rank in mlist.items():
-                matches_by_rank.setdefault(
-                    rank.key(), collections.OrderedDict()
-                ).setdefault(i, []).append(m)
+        for i, (mlist, names) in enumerate(zip(matches, name_matches)):
+            for m, n_matches in mlist.items():
+                rank = (n_matches, m in names)
+                group = matches_by_rank.get(rank)
+                if group is None:
+                    group = matches_by_rank[rank] = {}
+                neighbors = group.get(i)
+                if neighbors is None:
+                    group[i] = [m]
+                else:
+                    neighbors.append(m)
         # Sort descending by rank, then throw out the ranks since we no longer
         # need them.
-        return [
-            match
-            for _, match in sorted(
-                matches_by_rank.items(), key=lambda x: x[0], reverse=True
-            )
-        ]
+        return [matches_by_rank[rank] for rank in sorted(matches_by_rank, reverse=True)]
 
     @staticmethod
     def _maximum_bipartite_matching(
@@ -707,19 +925,17 @@ class SymbolList(list):
         for edges in matches:
             # Filter out already indexes that we've already paired; higher
             # match ranks always win conflicts
-            edges = collections.OrderedDict(
-                (
-                    i_self,
-                    [i_base for i_base in base_idxs if i_base not in paired_base_idxs],
-                )
-                for i_self, base_idxs in edges.items()
-                if i_self not in self_to_base_idx
+            unpaired_edges: Dict[int, List[int]] = {}
+            for i_self, base_idxs in edges.items():
+                if i_self in self_to_base_idx:
+                    continue
+                unpaired = [i for i in base_idxs if i not in paired_base_idxs]
                 # Make sure no keys correspond to an empty list
-                and not (set(base_idxs) <= paired_base_idxs)
-            )
+                if unpaired:
+                    unpaired_edges[i_self] = unpaired
             # Assign pairs from matches among the same rank by computing a
             # maximum cardinality matching
-            pairs = SymbolList._maximum_bipartite_matching(edges)
+            pairs = SymbolList._maximum_bipartite_matching(unpaired_edges)
             self_to_base_idx.update(pairs)
             paired_base_idxs.update(p[1] for p in pairs)
 
@@ -796,7 +1012,12 @@ class SymbolTable:
     """
 
     def __init__(
-        self, path: Path, *, revision: Optional[str] = None, descriptions: bool = False
+        self,
+        path: Path,
+        *,
+        revision: Optional[str] = None,
+        descriptions: bool = False,
+        file_cache: Optional[SymbolFileCache] = None,
     ):
         """
         Load a symbol table at the given path and revision, and its associated
@@ -809,11 +1030,12 @@ class SymbolTable:
                 working tree. Defaults to None.
             descriptions (bool, optional): Whether or not to load symbol
                 descriptions. Defaults to False.
+            file_cache (Optional[SymbolFileCache], optional): Preloaded symbol
+                table files to read from, if any. Defaults to None.
         """
         self.blocks: Dict[str, SymbolBlock] = {}
         try:
-            with open_file_at_revision(path, revision) as f:
-                contents = yaml.safe_load(f)
+            contents = load_file_at_revision(path, revision, file_cache)
             self.valid = True
         except FileNotFoundError:
             # This file doesn't exist in the given revision; mark it as invalid
@@ -862,8 +1084,7 @@ class SymbolTable:
             while subregions:
                 sub_path = subregions.pop()
                 try:
-                    with open_file_at_revision(sub_path, revision) as f:
-                        sub_contents = yaml.safe_load(f)
+                    sub_contents = load_file_at_revision(sub_path, revision, file_cache)
                 except FileNotFoundError:
                     continue
                 process_subregion(sub_path, sub_contents)
@@ -910,6 +1131,7 @@ def print_symbol_diff(
     subregion_resolution: bool = False,
     descriptions: bool = False,
     preceding_newline: bool = False,
+    file_cache: Optional[SymbolFileCache] = None,
 ) -> bool:
     """Print a diff for the given symbol table file between two revisions.
 
@@ -927,12 +1149,18 @@ def print_symbol_diff(
             description changes in the diff. Defaults to False.
         preceding_newline (bool, optional): whether to print a newline before
             a nonempty symbol diff, for fenceposting. Defaults to False.
+        file_cache (Optional[SymbolFileCache], optional): preloaded symbol
+            table files to read from, if any. Defaults to None.
 
     Returns:
             bool: True if the symbol diff was nonempty
     """
-    old_table = SymbolTable(path, revision=base, descriptions=descriptions)
-    new_table = SymbolTable(path, revision=target, descriptions=descriptions)
+    old_table = SymbolTable(
+        path, revision=base, descriptions=descriptions, file_cache=file_cache
+    )
+    new_table = SymbolTable(
+        path, revision=target, descriptions=descriptions, file_cache=file_cache
+    )
     diff = new_table.diff(old_table, subregion_resolution)
     if diff and (old_table.valid or new_table.valid):
         if preceding_newline:
@@ -1024,10 +1252,26 @@ def symdiff_parse_args(parser: argparse.ArgumentParser) -> argparse.Namespace:
     """Like parser.parse_args(), but with added processing similar to git.
 
     This appends the following optional arguments to the end of the parser:
-      [base] [target] [--] [path ...]
+      [-b] [-j JOBS] [base] [target] [--] [path ...]
     With appropriate help text, processing, and validation for symbol table
     diffing.
     """
+    parser.add_argument(
+        "-b",
+        "--batch",
+        action="store_true",
+        help=(
+            "load all symbol table files up front through a single git process"
+            + " (faster when comparing many files)"
+        ),
+    )
+    parser.add_argument(
+        "-j",
+        "--jobs",
+        type=int,
+        default=1,
+        help="number of worker processes for parsing symbol tables with --batch",
+    )
     parser.add_argument(
         "base", nargs="?", default="HEAD", help="base revision against which to compare"
     )
@@ -1099,6 +1343,16 @@ def symdiff_parse_args(parser: argparse.ArgumentParser) -> argparse.Namespace:
     return args
 
 
+def symbol_file_cache(args: argparse.Namespace) -> Optional[SymbolFileCache]:
+    """
+    Preload the symbol table files needed to compare the paths in args parsed
+    by symdiff_parse_args(), if batch loading was requested.
+    """
+    if not args.batch:
+        return None
+    return SymbolFileCache(args.path, [args.base, args.target], jobs=args.jobs)
+
+
 if __name__ == "__main__":
     parser = argparse.ArgumentParser(
         description="Compare Git revisions of the pmdsky-debug symbol tables.",
@@ -1125,6 +1379,7 @@ if __name__ == "__main__":
         help="count symbol description changes as a modification",
     )
     args = symdiff_parse_args(parser)
+    file_cache = symbol_file_cache(args)
 
     preceding_newline = False
     for path in args.path:
@@ -1136,4 +1391,5 @@ if __name__ == "__main__":
             subregion_resolution=args.subregion_resolution,
             descriptions=args.descriptions,
             preceding_newline=preceding_newline,
+            file_cache=file_cache,
         )
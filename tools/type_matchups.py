@@ -0,0 +1,134 @@
+#!/usr/bin/env python3
+
+"""
+`type_matchups.py` is a command line utility that generates a precombined
+type matchup table (`struct type_matchup_combined_table`) from the
+TYPE_MATCHUP_TABLE and TYPE_MATCHUP_COMBINATOR_TABLE of an overlay 10 binary.
+
+In the game, the matchup of an attack type against a defender is computed by
+looking up the matchup against each of the defender's two types separately,
+then combining the two results through TYPE_MATCHUP_COMBINATOR_TABLE (see
+GetTypeMatchupBothTypes). The generated table holds the combined result for
+every (attack type, type 1, type 2) triple, indexed by `enum type_id`, so a
+matchup can be looked up with a single load:
+    matchups[attack_type][type1][type2]
+Each entry is a single byte holding an `enum type_matchup` value.
+
+Note that this only covers the table-driven part of the matchup calculation.
+Special cases that depend on the attacker or defender (such as Ghost
+immunities) are not included.
+
+The table can be output either as a C source file that defines
+TYPE_MATCHUP_COMBINED_TABLE, or as a raw binary file of 18*18*18 bytes. The
+table addresses are read from the pmdsky-debug symbol tables (see
+binary_tables.py).
+
+Example usage:
+python3 type_matchups.py </path/to/EoS_NA_unpacked_dir>/overlay/overlay_0010.bin > type_matchups.c
+python3 type_matchups.py -v EU -f bin -o type_matchups.bin </path/to/overlay_0010.bin>
+"""
+
+import argparse
+from pathlib import Path
+import struct
+import sys
+from typing import List
+
+from binary_tables import BinaryFile
+
+# Number of types in TYPE_MATCHUP_TABLE (TYPE_NONE through TYPE_STEEL)
+N_TYPES = 18
+# Number of values of enum type_matchup
+N_MATCHUPS = 4
+
+
+def combine_tables(matchup_table: List[int], combinator: List[int]) -> bytes:
+    """Flattens the matchup table and combinator table into a combined table"""
+    combined = bytearray(N_TYPES**3)
+    for attack in range(N_TYPES):
+        row = matchup_table[attack * N_TYPES : (attack + 1) * N_TYPES]
+        for type1, m1 in enumerate(row):
+            for type2, m2 in enumerate(row):
+                index = (attack * N_TYPES + type1) * N_TYPES + type2
+                combined[index] = combinator[m1 * N_MATCHUPS + m2]
+    return bytes(combined)
+
+
+def read_combined_table(overlay10: BinaryFile) -> bytes:
+    matchup_table = struct.unpack(
+        f"<{N_TYPES * N_TYPES}H",
+        overlay10.read(
+            overlay10.table_address("TYPE_MATCHUP_TABLE"), N_TYPES * N_TYPES * 2
+        ),
+    )
+    combinator = struct.unpack(
+        f"<{N_MATCHUPS * N_MATCHUPS}I",
+        overlay10.read(
+            overlay10.table_address("TYPE_MATCHUP_COMBINATOR_TABLE"),
+            N_MATCHUPS * N_MATCHUPS * 4,
+        ),
+    )
+    for value in matchup_table + combinator:
+        if value >= N_MATCHUPS:
+            raise ValueError(f"invalid type matchup value {value}")
+    return combine_tables(matchup_table, combinator)
+
+
+def write_c_source(out, version: str, combined: bytes):
+    out.write(
+        f"// Generated by type_matchups.py from the {version} overlay 10 binary. Do not edit.\n\n"
+        "const struct type_matchup_combined_table TYPE_MATCHUP_COMBINED_TABLE = {\n"
+    )
+    for attack in range(N_TYPES):
+        out.write("    {\n")
+        for type1 in range(N_TYPES):
+            start = (attack * N_TYPES + type1) * N_TYPES
+            entries = ", ".join(f"{{{m}}}" for m in combined[start : start + N_TYPES])
+            out.write(f"        {{{entries}}},\n")
+        out.write("    },\n")
+    out.write("};\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Generate a precombined EoS type matchup table"
+    )
+    parser.add_argument(
+        "-v",
+        "--version",
+        choices=["NA", "EU", "JP"],
+        type=str.upper,
+        default="NA",
+        help="EoS version",
+    )
+    parser.add_argument(
+        "-f",
+        "--format",
+        choices=["c", "bin"],
+        default="c",
+        help="output format (default: c)",
+    )
+    parser.add_argument(
+        "-o", "--output", help="output file (default: standard output)"
+    )
+    parser.add_argument("overlay10", help="overlay 10 binary file")
+    args = parser.parse_args()
+
+    combined = read_combined_table(
+        BinaryFile(args.overlay10, args.version, "overlay10")
+    )
+
+    if args.format == "bin":
+        if args.output is None:
+            sys.stdout.buffer.write(combined)
+        else:
+            Path(args.output).write_bytes(combined)
+    elif args.output is None:
+        write_c_source(sys.stdout, args.version, combined)
+    else:
+        with open(args.output, "w") as f:
+            write_c_source(f, args.version, combined)
+
+
+if __name__ == "__main__":
+    main()